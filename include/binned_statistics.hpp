@@ -0,0 +1,185 @@
+#ifndef BINNED_STATISTICS_HPP
+#define BINNED_STATISTICS_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "sufficient_statistics.hpp"
+#include "system_identification.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief Grid edges of a BinnedStatistics
+ */
+struct BinningOptions {
+    double maxVelocity;             // Velocity covered by the grid (RPM); faster samples go to the edge bins
+    double accelerationThreshold;   // |a| below this is the steady bin (RPM/s)
+
+    BinningOptions(double velocity = 600.0, double acceleration = 200.0)
+        : maxVelocity(velocity), accelerationThreshold(acceleration) {}
+};
+
+/**
+ * @brief Moments of the samples that fell into one bin
+ */
+struct BinCell {
+    std::uint32_t count;
+    double mean[3];       // Mean velocity (RPM), acceleration (RPM/s) and voltage (V)
+    double moments[6];    // Centered sums of products: vv, va, vy, aa, ay, yy
+
+    BinCell() : count(0), mean(), moments() {}
+};
+
+/**
+ * @brief Constant-memory summary of a capture of any length
+ *
+ * Samples are binned by voltage (1 V bins over +-12 V), velocity (equal
+ * bins either side of zero plus one bin for exactly zero) and acceleration
+ * (decelerating, steady, accelerating). Each cell keeps its count, means
+ * and centered second moments, updated with Welford's method, so the
+ * memory is fixed when the object is created and never grows.
+ *
+ * Every cell has a single friction sign, so the regression's sufficient
+ * statistics rebuild exactly from the cells: a fit on the bins matches a
+ * fit on the raw samples. Optionally each cell's weight is capped, so
+ * hours spent at one operating point do not drown out brief ones.
+ *
+ * The occupied cells are also a compact archive of the capture; save()
+ * writes them to a checksummed file that load() reads back.
+ */
+class BinnedStatistics {
+public:
+    static constexpr int kVoltageBins = 24;
+    static constexpr int kVelocityHalfBins = 12;
+    static constexpr int kVelocityBins = 2 * kVelocityHalfBins + 1;  // Negative, zero, positive
+    static constexpr int kAccelerationBins = 3;
+    static constexpr int kCellCount = kVoltageBins * kVelocityBins * kAccelerationBins;
+    static constexpr double kMaxVoltage = 12.0;
+
+    /**
+     * @brief Create an empty grid (allocates all cells once)
+     * @param options Grid edges
+     * @param source Voltage used as the response when adding data points
+     */
+    explicit BinnedStatistics(const BinningOptions& options = BinningOptions(),
+                              VoltageSource source = VOLTAGE_COMMANDED);
+
+    /**
+     * @brief Empty every cell (the grid and voltage source are kept)
+     */
+    void clear();
+
+    /**
+     * @brief Select the response used when adding data points
+     * @param source Commanded or measured applied voltage
+     */
+    void setVoltageSource(VoltageSource source) {
+        voltageSource = source;
+    }
+
+    /**
+     * @brief Add one sample
+     * @param velocity Velocity (RPM)
+     * @param acceleration Acceleration (RPM/s)
+     * @param voltage Response voltage (V)
+     * @return False if a value was not finite
+     */
+    bool add(double velocity, double acceleration, double voltage);
+
+    /**
+     * @brief Add a data point, skipping it where SystemIdentification would
+     * @param point Sample
+     * @return False if the sample was skipped
+     */
+    bool add(const DataPoint& point);
+
+    /**
+     * @brief Rebuild the regression's sufficient statistics from the cells
+     * @param maxCellCount Largest weight of one cell in samples; 0 keeps every sample's weight
+     * @return Statistics equivalent to the binned samples
+     */
+    SufficientStatistics toStatistics(std::uint32_t maxCellCount = 0) const;
+
+    /**
+     * @brief Solve a sub-model from the cells
+     * @param terms Bitmask of ModelTerm values to include
+     * @param maxCellCount Largest weight of one cell in samples; 0 keeps every sample's weight
+     * @return Fit
+     */
+    StatisticsFit solve(std::uint32_t terms = TERM_ALL, std::uint32_t maxCellCount = 0) const {
+        return toStatistics(maxCellCount).solve(terms);
+    }
+
+    /**
+     * @brief Write the occupied cells to a file
+     * @param filename Output filename (e.g. "/usd/capture.mcbn")
+     * @return True if the file was written
+     */
+    bool save(const std::string& filename) const;
+
+    /**
+     * @brief Replace the contents with an archive written by save()
+     * @param filename Archive filename
+     * @return True if the archive was valid; the contents are cleared otherwise
+     */
+    bool load(const std::string& filename);
+
+    /**
+     * @brief Get a cell
+     * @param voltageBin Voltage bin, 0 .. kVoltageBins - 1
+     * @param velocityBin Velocity bin, 0 .. kVelocityBins - 1 (kVelocityHalfBins is zero velocity)
+     * @param accelerationBin 0 decelerating, 1 steady, 2 accelerating
+     * @return Cell
+     */
+    const BinCell& getCell(int voltageBin, int velocityBin, int accelerationBin) const {
+        return cells[cellIndex(voltageBin, velocityBin, accelerationBin)];
+    }
+
+    /**
+     * @brief Get the number of samples added
+     * @return Sample count
+     */
+    std::uint32_t getSampleCount() const {
+        return sampleCount;
+    }
+
+    /**
+     * @brief Get the number of cells holding samples
+     * @return Occupied cell count
+     */
+    int getOccupiedCells() const {
+        return occupiedCells;
+    }
+
+    /**
+     * @brief Get the grid edges
+     * @return Options the grid was created with
+     */
+    const BinningOptions& getOptions() const {
+        return options;
+    }
+
+private:
+    static int cellIndex(int voltageBin, int velocityBin, int accelerationBin) {
+        return (voltageBin * kVelocityBins + velocityBin) * kAccelerationBins + accelerationBin;
+    }
+
+    /**
+     * @brief Velocity bin of a cell index, which fixes the friction sign of its samples
+     */
+    static double cellSign(int index) {
+        int velocityBin = (index / kAccelerationBins) % kVelocityBins;
+        return static_cast<double>((velocityBin > kVelocityHalfBins) - (velocityBin < kVelocityHalfBins));
+    }
+
+    BinningOptions options;
+    VoltageSource voltageSource;
+    std::vector<BinCell> cells;
+    std::uint32_t sampleCount;
+    int occupiedCells;
+};
+
+} // namespace motor_characterization
+
+#endif // BINNED_STATISTICS_HPP
@@ -0,0 +1,189 @@
+#ifndef CHARACTERIZATION_HISTORY_HPP
+#define CHARACTERIZATION_HISTORY_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+#include "system_identification.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief Identity of a physical motor in the history store
+ *
+ * V5 motors do not report a serial number, so motors are identified by the
+ * label written on them plus the port they were tested on.
+ */
+struct MotorKey {
+    std::uint8_t port;
+    char label[15];  // Null-terminated, truncated if longer
+
+    MotorKey(std::uint8_t p = 0, const char* name = "");
+
+    bool operator==(const MotorKey& other) const;
+};
+
+/**
+ * @brief Kind of test that produced a history record
+ */
+enum HistoryTestType : std::uint8_t {
+    HISTORY_SINGLE_TEST = 0,
+    HISTORY_CONSISTENCY_TEST = 1,
+    HISTORY_FREQUENCY_TEST = 2,
+    HISTORY_ENDURANCE_TEST = 3
+};
+
+/**
+ * @brief One characterization result as stored on the SD card
+ *
+ * Fixed-size so the record file can be scanned and resynchronized after a
+ * torn write without any framing beyond the magic and checksum.
+ */
+struct HistoryRecord {
+    std::uint32_t magic;
+    std::uint32_t sequence;       // Global record number, increasing
+    std::int64_t unixTime;        // Wall-clock time if the brain has one, else 0
+    double kS;
+    double kV;
+    double kA;
+    std::uint32_t uptimeMs;       // pros::millis() when the result was recorded
+    float rSquared;
+    std::uint32_t dataPoints;
+    std::uint32_t durationMs;     // Length of the test
+    MotorKey key;
+    std::uint8_t testType;        // HistoryTestType
+    std::uint8_t runCount;        // Runs combined into this result
+    std::uint8_t reserved[2];
+    std::uint32_t crc;            // CRC-32 of all preceding bytes
+};
+
+static_assert(sizeof(HistoryRecord) == 80, "HistoryRecord is an on-disk format");
+
+/**
+ * @brief Compact summary of one past result used for trends
+ */
+struct HistoryTrendPoint {
+    std::int64_t unixTime;
+    std::uint32_t sequence;
+    float kS;
+    float kV;
+    float kA;
+    float rSquared;
+    std::uint32_t reserved;
+};
+
+/**
+ * @brief Index entry for one motor: latest result plus recent trend
+ */
+struct HistoryIndexEntry {
+    static constexpr std::size_t kTrendLength = 16;
+
+    MotorKey key;
+    std::uint32_t recordCount;
+    std::uint32_t trendCount;                    // Valid points in trend
+    HistoryRecord latest;
+    HistoryTrendPoint trend[kTrendLength];       // Oldest first
+};
+
+/**
+ * @brief Append-only, crash-safe history of characterization results
+ *
+ * Results are appended as checksummed fixed-size records to a data file that
+ * is never rewritten. A small index file holds, per motor, the latest record
+ * and a short trend, together with the data file length it covers. Loading
+ * reads the index and only scans records appended after it; a missing or
+ * corrupt index (e.g. power loss while it was rewritten) is rebuilt from the
+ * data file.
+ */
+class CharacterizationHistory {
+public:
+    /**
+     * @brief Create a history store
+     * @param directory Directory holding the data and index files
+     */
+    explicit CharacterizationHistory(const std::string& directory = "/usd");
+
+    /**
+     * @brief Load the index and catch up on records it does not cover
+     * @return True if the store is usable (an empty store counts as usable)
+     */
+    bool load();
+
+    /**
+     * @brief Append an identification result
+     * @param key Motor that was tested
+     * @param constants Identified constants
+     * @param rSquared Fit quality
+     * @param dataPoints Number of samples used
+     * @param durationMs Test duration
+     * @param testType Kind of test
+     * @param runCount Number of runs combined into the result
+     * @return True if the record was written
+     */
+    bool append(const MotorKey& key, const FeedforwardConstants& constants, double rSquared,
+                std::uint32_t dataPoints, std::uint32_t durationMs,
+                HistoryTestType testType = HISTORY_SINGLE_TEST, std::uint8_t runCount = 1);
+
+    /**
+     * @brief Find the index entry for a motor
+     * @param key Motor to look up
+     * @return Entry, or nullptr if the motor has no history
+     */
+    const HistoryIndexEntry* find(const MotorKey& key) const;
+
+    /**
+     * @brief Get all index entries
+     * @return One entry per motor
+     */
+    const std::vector<HistoryIndexEntry>& getEntries() const {
+        return entries;
+    }
+
+    /**
+     * @brief Read the full history of one motor by scanning the data file
+     * @param key Motor to look up
+     * @param records Receives the records, oldest first
+     * @return True if the data file could be read
+     */
+    bool readAll(const MotorKey& key, std::vector<HistoryRecord>& records) const;
+
+    /**
+     * @brief Get the total number of records in the store
+     * @return Record count
+     */
+    std::uint32_t getRecordCount() const {
+        return nextSequence;
+    }
+
+private:
+    /**
+     * @brief Scan the data file from an offset, applying valid records
+     * @param offset Byte offset to start from
+     * @return Data file length after the scan
+     */
+    long scanFrom(long offset);
+
+    /**
+     * @brief Fold a record into the in-memory index
+     * @param record Valid record
+     */
+    void applyRecord(const HistoryRecord& record);
+
+    /**
+     * @brief Rewrite the index file from the in-memory index
+     * @return True if the index was written
+     */
+    bool saveIndex() const;
+
+    std::string dataPath;
+    std::string indexPath;
+    std::vector<HistoryIndexEntry> entries;
+    std::uint32_t nextSequence;
+    long coveredBytes;
+    bool loaded;
+};
+
+} // namespace motor_characterization
+
+#endif // CHARACTERIZATION_HISTORY_HPP
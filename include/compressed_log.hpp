@@ -0,0 +1,245 @@
+#ifndef COMPRESSED_LOG_HPP
+#define COMPRESSED_LOG_HPP
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+#include "lz4_block.hpp"
+#include "system_identification.hpp"
+#include "telemetry_frame.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief On-disk layout of compressed capture logs
+ *
+ * A log is a file header followed by independent blocks. Each sample is
+ * a TelemetryFrame, whose integer fields (time, command, velocity,
+ * acceleration, applied and battery voltage, status, current, torque,
+ * power, efficiency, temperature, position, faults, hardware bits and
+ * channel mask, in that order) are delta-encoded against the previous
+ * sample of the same block, zigzag mapped and written as LEB128 varints.
+ * Fields of disabled channels stay zero and cost one byte. The varint
+ * stream of a block is then LZ4 compressed.
+ *
+ * Every block starts its deltas from zero, so a damaged block only loses its
+ * own samples and readers never need more than one block in memory.
+ */
+namespace compressed_log {
+    constexpr std::uint32_t kMagic = 0x5A4C434D;   // "MCLZ"
+    constexpr std::uint16_t kVersion = 3;
+    constexpr std::size_t kFieldCount = 16;
+    constexpr std::size_t kVersion2FieldCount = 7;  // Version 2 logs stop after the saturation flag
+    constexpr std::size_t kVersion1FieldCount = 4;  // Version 1 logs have no voltage telemetry
+    constexpr std::size_t kMaxRecordBytes = kFieldCount * 5;
+    constexpr std::size_t kBlockSize = 8192;        // Raw varint bytes per block
+
+    constexpr double kTimestampScale = telemetry::kTimeScale;
+    constexpr double kVoltageScale = telemetry::kVoltageScale;
+    constexpr double kVelocityScale = telemetry::kVelocityScale;
+    constexpr double kAccelerationScale = telemetry::kAccelerationScale;
+
+    /**
+     * @brief File header
+     */
+    struct FileHeader {
+        std::uint32_t magic;
+        std::uint16_t version;
+        std::uint16_t fieldCount;
+    };
+
+    /**
+     * @brief Header preceding every block
+     */
+    struct BlockHeader {
+        std::uint32_t rawSize;         // Varint bytes before compression
+        std::uint32_t compressedSize;  // Stored bytes (equal to rawSize if stored uncompressed)
+        std::uint32_t sampleCount;     // Samples in this block
+    };
+} // namespace compressed_log
+
+/**
+ * @brief Streaming compressed logger for long captures
+ *
+ * append() only varint-encodes the frame into the active block buffer,
+ * which costs a few hundred cycles and never touches the SD card.
+ * Full blocks are handed to a background task that compresses them and
+ * writes them out while the capture keeps filling the other buffer.
+ */
+class CompressedLogWriter {
+public:
+    CompressedLogWriter();
+    ~CompressedLogWriter();
+
+    CompressedLogWriter(const CompressedLogWriter&) = delete;
+    CompressedLogWriter& operator=(const CompressedLogWriter&) = delete;
+
+    /**
+     * @brief Create the log file and start the background compression task
+     * @param filename Output filename (e.g. "/usd/capture.mclz")
+     * @return True if the file was created
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Append a frame to the log
+     * @param frame Frame to record
+     */
+    void append(const TelemetryFrame& frame);
+
+    /**
+     * @brief Append a sample to the log
+     * @param point Sample to record (quantized to a frame)
+     */
+    void append(const DataPoint& point);
+
+    /**
+     * @brief Flush the partial block, stop the background task and close the file
+     * @return True if every block was written successfully
+     */
+    bool close();
+
+    /**
+     * @brief Check whether the log is open
+     * @return True between a successful open() and close()
+     */
+    bool isOpen() const {
+        return file != nullptr;
+    }
+
+    /**
+     * @brief Get the number of samples appended so far
+     * @return Sample count
+     */
+    size_t getSampleCount() const {
+        return sampleCount;
+    }
+
+    /**
+     * @brief Get the number of uncompressed varint bytes produced so far
+     * @return Raw byte count of all submitted blocks
+     */
+    size_t getRawBytes() const {
+        return rawBytes;
+    }
+
+    /**
+     * @brief Get the number of bytes written to the file so far
+     * @return File size including headers
+     */
+    size_t getWrittenBytes() const {
+        return writtenBytes;
+    }
+
+private:
+    struct Block {
+        std::array<std::uint8_t, compressed_log::kBlockSize> data;
+        std::size_t size = 0;
+        std::uint32_t samples = 0;
+        std::array<std::int32_t, compressed_log::kFieldCount> previous{};
+    };
+
+    /**
+     * @brief Hand the active block to the background task and switch buffers
+     */
+    void submitActiveBlock();
+
+    /**
+     * @brief Compress a block and write it to the file (background task)
+     * @param block Block to write
+     */
+    void writeBlock(Block& block);
+
+    /**
+     * @brief Background task body
+     */
+    void compressionLoop();
+
+    std::FILE* file;
+    std::array<Block, 2> blocks;
+    std::size_t activeBlock;
+    std::atomic<int> pendingBlock;  // Index of the block waiting for the task, or -1
+    std::atomic<bool> running;
+    std::atomic<bool> failed;
+    std::vector<std::uint8_t> compressed;
+    Lz4BlockCodec codec;
+    std::unique_ptr<pros::Task> task;
+    size_t sampleCount;
+    std::atomic<size_t> rawBytes;
+    std::atomic<size_t> writtenBytes;
+};
+
+/**
+ * @brief Streaming reader for compressed capture logs
+ *
+ * Decompresses one block at a time, so replaying a multi-hour log needs only
+ * a couple of block buffers regardless of its length.
+ */
+class CompressedLogReader {
+public:
+    CompressedLogReader();
+    ~CompressedLogReader();
+
+    CompressedLogReader(const CompressedLogReader&) = delete;
+    CompressedLogReader& operator=(const CompressedLogReader&) = delete;
+
+    /**
+     * @brief Open a log and validate its header
+     * @param filename Log filename
+     * @return True if the file is a compressed log of a supported version
+     */
+    bool open(const std::string& filename);
+
+    /**
+     * @brief Read the next frame
+     *
+     * Frames from older logs carry only the channels those versions stored.
+     *
+     * @param frame Receives the decoded frame
+     * @return True if a frame was read, false at end of log or on a damaged block
+     */
+    bool next(TelemetryFrame& frame);
+
+    /**
+     * @brief Read the next sample
+     * @param point Receives the decoded sample
+     * @return True if a sample was read, false at end of log or on a damaged block
+     */
+    bool next(DataPoint& point);
+
+    /**
+     * @brief Replay every remaining sample into an identification object
+     * @param sysId Identification object to receive the samples
+     * @return Number of samples added
+     */
+    size_t readAll(SystemIdentification& sysId);
+
+    /**
+     * @brief Close the log
+     */
+    void close();
+
+private:
+    /**
+     * @brief Load and decompress the next block
+     * @return True if a block with samples was loaded
+     */
+    bool loadBlock();
+
+    std::FILE* file;
+    std::vector<std::uint8_t> compressed;
+    std::vector<std::uint8_t> raw;
+    std::size_t rawSize;
+    std::size_t position;
+    std::size_t fieldCount;
+    std::uint32_t remainingSamples;
+    std::array<std::int32_t, compressed_log::kFieldCount> previous;
+};
+
+} // namespace motor_characterization
+
+#endif // COMPRESSED_LOG_HPP
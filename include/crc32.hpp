@@ -0,0 +1,30 @@
+#ifndef CRC32_HPP
+#define CRC32_HPP
+
+#include <cstddef>
+#include <cstdint>
+
+namespace motor_characterization {
+
+/**
+ * @brief CRC-32 (IEEE 802.3) of a buffer, bitwise so it needs no table
+ * @param data Bytes to checksum
+ * @param length Number of bytes
+ * @param crc CRC of the preceding bytes, to checksum a file in pieces
+ * @return CRC-32
+ */
+inline std::uint32_t crc32(const void* data, std::size_t length, std::uint32_t crc = 0) {
+    const auto* bytes = static_cast<const std::uint8_t*>(data);
+    crc = ~crc;
+    for (std::size_t i = 0; i < length; ++i) {
+        crc ^= bytes[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            crc = (crc >> 1) ^ (0xEDB88320u & (~(crc & 1) + 1));
+        }
+    }
+    return ~crc;
+}
+
+} // namespace motor_characterization
+
+#endif // CRC32_HPP
@@ -0,0 +1,95 @@
+#ifndef CSV_WRITER_HPP
+#define CSV_WRITER_HPP
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace motor_characterization {
+
+/**
+ * @brief Buffered CSV row formatter
+ *
+ * Fields are formatted straight into a reusable byte buffer (integers with
+ * std::to_chars, decimals as scaled fixed-point integers) and the buffer is
+ * handed to the file in a few large fwrite calls. This avoids the per-field
+ * locale and stream-state overhead of iostream formatting, which dominates
+ * export time on the brain's SD card.
+ */
+class CsvWriter {
+public:
+    static constexpr std::size_t kDefaultBufferSize = 8192;
+    static constexpr int kMaxPrecision = 9;
+
+    /**
+     * @brief Create a writer for an already opened file
+     * @param file Output file (not owned, must stay open while writing)
+     * @param bufferSize Size of the staging buffer in bytes
+     */
+    explicit CsvWriter(std::FILE* file, std::size_t bufferSize = kDefaultBufferSize);
+
+    ~CsvWriter() { flush(); }
+
+    CsvWriter(const CsvWriter&) = delete;
+    CsvWriter& operator=(const CsvWriter&) = delete;
+
+    /**
+     * @brief Write a text field (used for headers, no quoting is applied)
+     * @param text Null-terminated field contents
+     */
+    void writeText(const char* text);
+
+    /**
+     * @brief Write a decimal field with a fixed number of fractional digits
+     * @param value Value to format
+     * @param precision Digits after the decimal point (0 to kMaxPrecision)
+     */
+    void writeField(double value, int precision);
+
+    /**
+     * @brief Write an integer field
+     * @param value Value to format
+     */
+    void writeField(std::int64_t value);
+
+    /**
+     * @brief Terminate the current row
+     */
+    void endRow();
+
+    /**
+     * @brief Write all buffered bytes to the file
+     * @return True if every write so far has succeeded
+     */
+    bool flush();
+
+    /**
+     * @brief Check whether any write has failed
+     * @return True if all writes so far have succeeded
+     */
+    bool ok() const {
+        return !failed;
+    }
+
+private:
+    /**
+     * @brief Make room for at least the given number of bytes
+     * @param bytes Number of bytes about to be written
+     */
+    void reserve(std::size_t bytes);
+
+    /**
+     * @brief Emit the separator if the row already has a field
+     */
+    void beginField();
+
+    std::FILE* file;
+    std::vector<char> buffer;
+    std::size_t used;
+    bool rowHasField;
+    bool failed;
+};
+
+} // namespace motor_characterization
+
+#endif // CSV_WRITER_HPP
@@ -0,0 +1,166 @@
+#ifndef ENDURANCE_MONITOR_HPP
+#define ENDURANCE_MONITOR_HPP
+
+#include <cstdint>
+#include "fixed_point_statistics.hpp"
+#include "running_statistics.hpp"
+#include "telemetry_frame.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief Settings of an endurance test
+ */
+struct EnduranceOptions {
+    int warmupWindows;          // Windows ignored while the motor warms up
+    int baselineWindows;        // Windows averaged into the baseline
+    double cusumSlack;          // Drift per window tolerated by the CUSUM (baseline standard deviations)
+    double cusumLimit;          // CUSUM level that counts as significant drift
+    double wearThreshold;       // Relative change of kS or kV from the baseline that ends the test
+    double smoothing;           // Weight of the newest window in the smoothed parameters
+    double minRelativeSpread;   // Floor of the baseline standard deviation, relative to its mean
+
+    EnduranceOptions()
+        : warmupWindows(3), baselineWindows(5), cusumSlack(0.5), cusumLimit(8.0), wearThreshold(0.15),
+          smoothing(0.2), minRelativeSpread(0.01) {}
+};
+
+/**
+ * @brief Where an endurance test stands
+ */
+enum EnduranceState {
+    ENDURANCE_WARMUP,      // Still in the warm-up windows
+    ENDURANCE_BASELINE,    // Collecting the baseline
+    ENDURANCE_MONITORING,  // Comparing windows against the baseline
+    ENDURANCE_DRIFTING,    // Significant drift, still below the wear threshold
+    ENDURANCE_WORN         // Significant drift beyond the wear threshold
+};
+
+/**
+ * @brief Result of one identification window
+ */
+struct EnduranceWindow {
+    std::uint32_t index;
+    double endTime;           // Test time at the end of the window (s)
+    double kS;
+    double kV;
+    double kA;
+    double rSquared;
+    std::uint32_t samples;
+    double meanTemperature;   // C, 0 without temperature telemetry
+    double rmsCurrent;        // A
+    double smoothedKS;        // Exponentially smoothed kS
+    double smoothedKV;
+    double driftKS;           // Larger of the two one-sided CUSUMs of kS
+    double driftKV;
+    EnduranceState state;
+
+    EnduranceWindow()
+        : index(0), endTime(0.0), kS(0.0), kV(0.0), kA(0.0), rSquared(0.0), samples(0), meanTemperature(0.0),
+          rmsCurrent(0.0), smoothedKS(0.0), smoothedKV(0.0), driftKS(0.0), driftKV(0.0),
+          state(ENDURANCE_WARMUP) {}
+};
+
+/**
+ * @brief Windowed identification and online drift detection for wear tests
+ *
+ * Frames are accumulated into FixedPointStatistics for the current window
+ * and solved when the window closes, so memory is the same after ten
+ * minutes or ten hours and nothing is allocated after construction.
+ *
+ * After the warm-up windows, the baseline windows give the mean and the
+ * window-to-window spread of kS and kV. Every later window is standardized
+ * against them and fed to a two-sided CUSUM, which flags a sustained shift
+ * of a fraction of a standard deviation without reacting to single noisy
+ * windows. The test is over once a parameter has drifted significantly and
+ * its smoothed value has moved past the wear threshold.
+ *
+ * Winding temperature also moves kV, which is why the warm-up windows are
+ * skipped and every window records its temperature.
+ */
+class EnduranceMonitor {
+public:
+    /**
+     * @brief Create a monitor
+     * @param options Window and drift settings
+     * @param source Voltage used as the regression response
+     */
+    explicit EnduranceMonitor(const EnduranceOptions& options = EnduranceOptions(),
+                              VoltageSource source = VOLTAGE_COMMANDED);
+
+    /**
+     * @brief Add a frame to the current window
+     * @param frame Frame from the sampler
+     */
+    void add(const TelemetryFrame& frame);
+
+    /**
+     * @brief Solve the current window, update the drift statistics and start a new window
+     * @param endTime Test time at the end of the window (s)
+     * @param window Receives the window result
+     * @return False if the window could not be identified (it is discarded)
+     */
+    bool closeWindow(double endTime, EnduranceWindow& window);
+
+    /**
+     * @brief Get the state after the last window
+     * @return State
+     */
+    EnduranceState getState() const {
+        return state;
+    }
+
+    /**
+     * @brief Check whether the wear threshold has been reached
+     * @return True once a parameter drifted significantly past the threshold
+     */
+    bool isWorn() const {
+        return state == ENDURANCE_WORN;
+    }
+
+    /**
+     * @brief Get the baseline mean of kS or kV
+     * @param parameter 0 for kS, 1 for kV
+     * @return Mean over the baseline windows seen so far (0 before the first)
+     */
+    double getBaseline(int parameter) const {
+        return baseline[parameter].getMean();
+    }
+
+    /**
+     * @brief Get the number of windows closed
+     * @return Window count, including discarded windows
+     */
+    std::uint32_t getWindowCount() const {
+        return windowCount;
+    }
+
+    /**
+     * @brief Get a short name for a state
+     * @param state State
+     * @return Name
+     */
+    static const char* describe(EnduranceState state);
+
+private:
+    static constexpr int kTracked = 2;  // kS and kV
+
+    EnduranceOptions options;
+    FixedPointStatistics window;
+    std::int64_t temperatureSum;
+    std::uint32_t temperatureCount;
+    std::int64_t currentSquaredSum;  // mA^2
+    std::uint32_t currentCount;
+
+    EnduranceState state;
+    std::uint32_t windowCount;
+    RunningStatistics baseline[kTracked];
+    double baselineSpread[kTracked];
+    double smoothed[kTracked];
+    double cusumHigh[kTracked];
+    double cusumLow[kTracked];
+};
+
+} // namespace motor_characterization
+
+#endif // ENDURANCE_MONITOR_HPP
@@ -0,0 +1,122 @@
+#ifndef FAULT_DETECTOR_HPP
+#define FAULT_DETECTOR_HPP
+
+#include <cstdint>
+
+namespace motor_characterization {
+
+/**
+ * @brief Conditions that make a sample or a run unusable, usable as a bitmask
+ */
+enum MotorFault : std::uint32_t {
+    FAULT_NONE          = 0,
+    FAULT_STALL         = 1u << 0,  // High current with the motor not turning
+    FAULT_OVER_TEMP     = 1u << 1,  // Motor is limiting power to protect itself from heat
+    FAULT_CURRENT_LIMIT = 1u << 2,  // Motor is holding current at its limit
+    FAULT_DRIVER        = 1u << 3,  // H-bridge fault or driver over-current
+    FAULT_NO_RESPONSE   = 1u << 4   // Motor did not answer (unplugged or busy)
+};
+
+/**
+ * @brief Raw health readings of a motor for one tick
+ */
+struct MotorHealth {
+    std::uint32_t faults;   // pros::motor_fault_e_t bits
+    std::uint32_t flags;    // pros::motor_flag_e_t bits
+    std::int32_t current;   // Current draw (mA)
+    bool valid;             // False if the motor could not be read
+
+    MotorHealth() : faults(0), flags(0), current(0), valid(false) {}
+};
+
+/**
+ * @brief Thresholds and actions of the fault detector
+ */
+struct FaultDetectorOptions {
+    std::int32_t stallCurrent;   // Current above which a slow motor counts as stalled (mA)
+    double stallVelocity;        // Speed below which the motor counts as not turning (RPM)
+    double stallVoltage;         // Command below which low speed is expected (V)
+    int stallTicks;              // Consecutive ticks before a stall is reported (spin-up draws high current too)
+    std::uint32_t abortFaults;   // MotorFault bits that end the run
+    std::uint32_t maskFaults;    // MotorFault bits that only remove the sample from the fit
+
+    FaultDetectorOptions(std::int32_t current = 2000, double velocity = 5.0, double voltage = 3.0, int ticks = 25,
+                         std::uint32_t abort = FAULT_STALL | FAULT_OVER_TEMP | FAULT_DRIVER,
+                         std::uint32_t mask = FAULT_CURRENT_LIMIT | FAULT_NO_RESPONSE)
+        : stallCurrent(current), stallVelocity(velocity), stallVoltage(voltage), stallTicks(ticks),
+          abortFaults(abort), maskFaults(mask) {}
+};
+
+/**
+ * @brief Streaming detector of stall, thermal and current limits
+ *
+ * Fed one MotorHealth reading per tick. Hardware fault bits are reported
+ * on the tick they appear; a stall needs stallTicks consecutive ticks of
+ * high current at low speed under a real command, so normal spin-up is not
+ * mistaken for one. Faults in abortFaults latch until clear(); the caller
+ * checks shouldAbort() after every sample and stops within the same tick.
+ */
+class FaultDetector {
+public:
+    explicit FaultDetector(const FaultDetectorOptions& options = FaultDetectorOptions()) : options(options) {
+        clear();
+    }
+
+    /**
+     * @brief Forget latched faults and the stall counter
+     */
+    void clear() {
+        stallCount = 0;
+        latched = FAULT_NONE;
+    }
+
+    /**
+     * @brief Classify one tick
+     * @param health Readings for this tick
+     * @param velocity Measured velocity (RPM)
+     * @param commandedVoltage Voltage being commanded (V)
+     * @return MotorFault bits present on this tick
+     */
+    std::uint32_t update(const MotorHealth& health, double velocity, double commandedVoltage);
+
+    /**
+     * @brief Check whether a fault that ends the run has been seen
+     * @return True once any abort fault has latched
+     */
+    bool shouldAbort() const {
+        return (latched & options.abortFaults) != 0;
+    }
+
+    /**
+     * @brief Get every fault seen since clear()
+     * @return MotorFault bits
+     */
+    std::uint32_t getLatchedFaults() const {
+        return latched;
+    }
+
+    /**
+     * @brief Check whether a sample with these faults should be left out of the fit
+     * @param faults MotorFault bits of the sample
+     * @return True if any bit is an abort or mask fault
+     */
+    bool isMasked(std::uint32_t faults) const {
+        return (faults & (options.abortFaults | options.maskFaults)) != 0;
+    }
+
+    /**
+     * @brief Short name of the most serious fault in a set
+     * @param faults MotorFault bits
+     * @return Name such as "stall", or "none"
+     */
+    static const char* describe(std::uint32_t faults);
+
+private:
+    FaultDetectorOptions options;
+    int stallCount;
+    std::uint32_t latched;
+};
+
+} // namespace motor_characterization
+
+#endif // FAULT_DETECTOR_HPP
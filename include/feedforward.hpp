@@ -0,0 +1,118 @@
+#ifndef FEEDFORWARD_HPP
+#define FEEDFORWARD_HPP
+
+#include <cstdint>
+#include <span>
+
+namespace motor_characterization {
+
+/**
+ * @brief Sign of a velocity for the static friction term, with a deadband
+ *
+ * Returns +1 above the deadband, -1 below its negative, and 0 inside it, so
+ * a motor at rest gets no static friction compensation. Written with
+ * comparisons instead of branches so batch loops stay vectorizable.
+ *
+ * @param velocity Velocity (RPM)
+ * @param deadband Half-width of the zero band (RPM)
+ * @return -1, 0 or +1
+ */
+inline double frictionSign(double velocity, double deadband = 0.0) {
+    return static_cast<double>((velocity > deadband) - (velocity < -deadband));
+}
+
+/**
+ * @brief Feedforward constants structure
+ */
+struct FeedforwardConstants {
+    double kS;  // Static friction constant
+    double kV;  // Velocity feedforward constant
+    double kA;  // Acceleration feedforward constant
+    double velocityDeadband;  // Velocities within +/- this get no kS term (RPM)
+    
+    FeedforwardConstants(double s = 0.0, double v = 0.0, double a = 0.0, double deadband = 0.0) 
+        : kS(s), kV(v), kA(a), velocityDeadband(deadband) {}
+    
+    // Calculate feedforward output
+    double calculate(double velocity, double acceleration) const {
+        return kS * frictionSign(velocity, velocityDeadband) + kV * velocity + kA * acceleration;
+    }
+
+    /**
+     * @brief Calculate feedforward voltages for a whole trajectory
+     * @param velocities Velocities (RPM)
+     * @param accelerations Accelerations (RPM/s), same length as velocities
+     * @param voltages Receives the voltages (V), same length as velocities
+     */
+    void calculate(std::span<const double> velocities, std::span<const double> accelerations,
+                   std::span<double> voltages) const;
+
+    /**
+     * @brief Single-precision batch evaluation (NEON on the V5 brain)
+     * @param velocities Velocities (RPM)
+     * @param accelerations Accelerations (RPM/s), same length as velocities
+     * @param voltages Receives the voltages (V), same length as velocities
+     */
+    void calculate(std::span<const float> velocities, std::span<const float> accelerations,
+                   std::span<float> voltages) const;
+};
+
+/**
+ * @brief Integer-only feedforward evaluation
+ *
+ * Inputs are Q16.16 RPM and RPM/s, output is millivolts ready for
+ * move_voltage. Coefficients are stored as millivolts per unit in Q16.16,
+ * so each term is one 32x32->64 multiply.
+ */
+struct FixedPointFeedforward {
+    static constexpr int kFractionBits = 16;
+
+    std::int32_t kSMillivolts;
+    std::int32_t kV;        // mV per RPM, Q16.16
+    std::int32_t kA;        // mV per RPM/s, Q16.16
+    std::int32_t deadband;  // RPM, Q16.16
+
+    explicit FixedPointFeedforward(const FeedforwardConstants& constants);
+
+    /**
+     * @brief Convert a value to Q16.16
+     * @param value Value to convert
+     * @return Rounded fixed-point value
+     */
+    static std::int32_t toFixed(double value);
+
+    /**
+     * @brief Calculate one feedforward voltage
+     * @param velocity Velocity (RPM, Q16.16)
+     * @param acceleration Acceleration (RPM/s, Q16.16)
+     * @return Voltage (mV)
+     */
+    std::int32_t calculate(std::int32_t velocity, std::int32_t acceleration) const {
+        std::int32_t sign = (velocity > deadband) - (velocity < -deadband);
+        std::int64_t scaled = static_cast<std::int64_t>(kV) * velocity +
+                              static_cast<std::int64_t>(kA) * acceleration;
+        return kSMillivolts * sign +
+               static_cast<std::int32_t>((scaled + (std::int64_t(1) << (2 * kFractionBits - 1))) >> (2 * kFractionBits));
+    }
+
+    /**
+     * @brief Calculate feedforward voltages for a whole trajectory
+     * @param velocities Velocities (RPM, Q16.16)
+     * @param accelerations Accelerations (RPM/s, Q16.16), same length as velocities
+     * @param millivolts Receives the voltages (mV), same length as velocities
+     */
+    void calculate(std::span<const std::int32_t> velocities, std::span<const std::int32_t> accelerations,
+                   std::span<std::int32_t> millivolts) const;
+};
+
+/**
+ * @brief Time the batch evaluators against the scalar one and print the results
+ * @param constants Constants to evaluate
+ * @param samples Trajectory length
+ * @param repetitions Number of passes over the trajectory per variant
+ */
+void benchmarkFeedforward(const FeedforwardConstants& constants, std::size_t samples = 4096, int repetitions = 20);
+
+} // namespace motor_characterization
+
+#endif // FEEDFORWARD_HPP
@@ -0,0 +1,216 @@
+#ifndef FEEDFORWARD_TABLE_HPP
+#define FEEDFORWARD_TABLE_HPP
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "feedforward.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief Grid covered by a feedforward table
+ *
+ * Node spacing must be more than 1 RPM (RPM/s) so the fixed-point lookup can
+ * use a 32-bit reciprocal of the step. Inputs outside the grid are clamped.
+ */
+struct FeedforwardTableSpec {
+    double velocityMin = -600.0;        // RPM
+    double velocityMax = 600.0;
+    std::uint16_t velocityCount = 49;   // Nodes, including both ends
+    double accelerationMin = -6000.0;   // RPM/s
+    double accelerationMax = 6000.0;
+    std::uint16_t accelerationCount = 13;
+};
+
+/**
+ * @brief Discontinuous friction step that is applied exactly, not interpolated
+ *
+ * Friction models jump at zero velocity. Interpolating across the jump would
+ * put an error of up to kS into the cells next to it, so the table stores the
+ * model minus this step and the lookup adds the step back.
+ */
+struct FrictionStep {
+    double positive = 0.0;  // Added above +deadband (V)
+    double negative = 0.0;  // Subtracted below -deadband (V)
+    double deadband = 0.0;  // RPM
+
+    /**
+     * @brief Evaluate the step
+     * @param velocity Velocity (RPM)
+     * @return Step voltage (V)
+     */
+    double evaluate(double velocity) const {
+        return positive * (velocity > deadband) - negative * (velocity < -deadband);
+    }
+};
+
+/**
+ * @brief Fixed layout header of a table; followed by the int16 node values
+ *
+ * Values are millivolts stored row-major by acceleration
+ * (index = accelerationIndex * velocityCount + velocityIndex). All fields
+ * are integers so a table can be compiled into flash as plain constants.
+ */
+struct FeedforwardTableHeader {
+    std::uint32_t magic;
+    std::uint16_t velocityCount;
+    std::uint16_t accelerationCount;
+    std::int32_t velocityMin;           // RPM, Q16.16
+    std::int32_t accelerationMin;       // RPM/s, Q16.16
+    std::uint32_t velocityReciprocal;   // 2^32 / velocity step (RPM)
+    std::uint32_t accelerationReciprocal;
+    std::int32_t velocityRange;         // RPM from the first node to the last, Q16.16
+    std::int32_t accelerationRange;     // RPM/s, Q16.16
+    std::int32_t stepPositive;          // mV
+    std::int32_t stepNegative;          // mV
+    std::int32_t deadband;              // RPM, Q16.16
+    std::uint32_t maxErrorMicrovolts;   // Measured against the analytic model
+};
+
+/**
+ * @brief Constant-time bilinear lookup over a table in RAM or flash
+ */
+class FeedforwardTableView {
+public:
+    FeedforwardTableView(const FeedforwardTableHeader* header, const std::int16_t* values)
+        : header(header), values(values) {}
+
+    /**
+     * @brief Look up a feedforward voltage
+     * @param velocity Velocity (RPM, Q16.16)
+     * @param acceleration Acceleration (RPM/s, Q16.16)
+     * @return Voltage (mV)
+     */
+    std::int32_t lookup(std::int32_t velocity, std::int32_t acceleration) const {
+        std::int32_t vIndex, vFraction, aIndex, aFraction;
+        locate(velocity, header->velocityMin, header->velocityRange, header->velocityReciprocal,
+               header->velocityCount, vIndex, vFraction);
+        locate(acceleration, header->accelerationMin, header->accelerationRange, header->accelerationReciprocal,
+               header->accelerationCount, aIndex, aFraction);
+
+        const std::int16_t* row0 = values + aIndex * header->velocityCount + vIndex;
+        const std::int16_t* row1 = row0 + header->velocityCount;
+        std::int64_t low = (static_cast<std::int64_t>(row0[0]) << 16) + static_cast<std::int64_t>(row0[1] - row0[0]) * vFraction;
+        std::int64_t high = (static_cast<std::int64_t>(row1[0]) << 16) + static_cast<std::int64_t>(row1[1] - row1[0]) * vFraction;
+        std::int64_t value = (low << 16) + (high - low) * aFraction;
+
+        std::int32_t step = header->stepPositive * (velocity > header->deadband) -
+                            header->stepNegative * (velocity < -header->deadband);
+        return step + static_cast<std::int32_t>((value + (std::int64_t(1) << 31)) >> 32);
+    }
+
+    /**
+     * @brief Look up a feedforward voltage in floating point
+     * @param velocity Velocity (RPM)
+     * @param acceleration Acceleration (RPM/s)
+     * @return Voltage (V)
+     */
+    double lookup(double velocity, double acceleration) const {
+        return lookup(FixedPointFeedforward::toFixed(velocity), FixedPointFeedforward::toFixed(acceleration)) / 1000.0;
+    }
+
+    /**
+     * @brief Get the table header
+     * @return Header
+     */
+    const FeedforwardTableHeader& getHeader() const {
+        return *header;
+    }
+
+private:
+    /**
+     * @brief Find the cell holding a coordinate and the position inside it
+     * @param fraction Receives the position in the cell, 0..65536
+     */
+    static void locate(std::int32_t value, std::int32_t minimum, std::int32_t range, std::uint32_t reciprocal,
+                       std::uint16_t count, std::int32_t& index, std::int32_t& fraction) {
+        // Offset in RPM (Q16.16), clamped to the grid so the product below cannot overflow
+        std::int64_t offset = static_cast<std::int64_t>(value) - minimum;
+        offset = offset < 0 ? 0 : (offset > range ? range : offset);
+
+        // Times 2^32/step, shifted down to cells in Q16.16
+        std::int64_t position = static_cast<std::int64_t>((static_cast<std::uint64_t>(offset) * reciprocal) >> 32);
+        std::int64_t last = static_cast<std::int64_t>(count - 1) << 16;
+        position = position > last ? last : position;
+        index = static_cast<std::int32_t>(position >> 16);
+        index -= index == count - 1;  // Top edge uses the last cell at fraction 1
+        fraction = static_cast<std::int32_t>(position - (static_cast<std::int64_t>(index) << 16));
+    }
+
+    const FeedforwardTableHeader* header;
+    const std::int16_t* values;
+};
+
+/**
+ * @brief Generator for interpolated fixed-point feedforward tables
+ *
+ * Samples any model V = f(velocity, acceleration) on a grid once, so a
+ * control loop pays two cell lookups and a bilinear blend per tick however
+ * expensive the model is. After generation the table is swept at several
+ * points per cell against the model and the largest difference is recorded.
+ */
+class FeedforwardTable {
+public:
+    using Model = std::function<double(double velocity, double acceleration)>;
+
+    FeedforwardTable();
+
+    /**
+     * @brief Build a table from an arbitrary model
+     * @param model Feedforward model (V)
+     * @param step Discontinuous part of the model, applied exactly at lookup
+     * @param spec Grid to cover
+     * @return False if the grid is invalid or values do not fit in 16 bits
+     */
+    bool generate(const Model& model, const FrictionStep& step, const FeedforwardTableSpec& spec = {});
+
+    /**
+     * @brief Build a table from identified constants
+     * @param constants Feedforward constants
+     * @param spec Grid to cover
+     * @return False if the grid is invalid
+     */
+    bool generate(const FeedforwardConstants& constants, const FeedforwardTableSpec& spec = {});
+
+    /**
+     * @brief Get a lookup view of the table
+     * @return View referencing this table's storage
+     */
+    FeedforwardTableView view() const {
+        return FeedforwardTableView(&header, values.data());
+    }
+
+    /**
+     * @brief Get the largest lookup error seen against the model
+     * @return Maximum absolute error (V)
+     */
+    double getMaxError() const {
+        return header.maxErrorMicrovolts / 1e6;
+    }
+
+    /**
+     * @brief Get the table size as stored in flash
+     * @return Header plus values in bytes
+     */
+    std::size_t getSizeBytes() const {
+        return sizeof(header) + values.size() * sizeof(std::int16_t);
+    }
+
+    /**
+     * @brief Write the table as a C++ source file for compiling into flash
+     * @param filename Output filename
+     * @param name Identifier prefix for the generated constants
+     * @return True if the file was written
+     */
+    bool exportSource(const std::string& filename, const std::string& name) const;
+
+private:
+    FeedforwardTableHeader header;
+    std::vector<std::int16_t> values;
+};
+
+} // namespace motor_characterization
+
+#endif // FEEDFORWARD_TABLE_HPP
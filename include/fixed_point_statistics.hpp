@@ -0,0 +1,147 @@
+#ifndef FIXED_POINT_STATISTICS_HPP
+#define FIXED_POINT_STATISTICS_HPP
+
+#include <cstdint>
+#include <Eigen/Dense>
+#include "sufficient_statistics.hpp"
+#include "system_identification.hpp"
+#include "telemetry_frame.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief Sufficient statistics of the feedforward regression in 64-bit integers
+ *
+ * Samples arrive in the units of a TelemetryFrame (0.01 RPM, 0.1 RPM/s,
+ * mV), so every product and sum is an exact integer operation: ingest
+ * costs a dozen integer multiply-adds, never rounds, never allocates and
+ * gives the same sums in any order or split across merged blocks.
+ * Floating point only appears in toStatistics(), which converts the sums
+ * to a SufficientStatistics for the usual 3x3 solve.
+ *
+ * Overflow guard: a sample is rejected if a reading lies outside the
+ * ranges below, so no product exceeds 10^12 in magnitude, and the count is
+ * capped at kMaxSamples (about 25 hours at 100 Hz), so no sum can leave
+ * the int64 range. Rejected samples are counted, not added.
+ *
+ * Error bound against the double path (SufficientStatistics fed the
+ * unrounded readings): ingest adds no error, and converting the final sums
+ * to double is one rounding of relative size 2^-53 per entry, at or below
+ * what the double path accumulates on its own. The difference is therefore
+ * the rounding of the readings themselves, at most half a unit per
+ * sample: e = 0.5 mV + |kV| 0.005 RPM + |kA| 0.05 RPM/s in the response.
+ * By Cauchy-Schwarz each coefficient then moves by at most
+ * e sqrt(n [(X^T X)^-1]_jj) to first order; quantizationBound() evaluates
+ * this for a fit. It is a worst case for adversarial rounding; with
+ * rounding errors that are independent of the regressors the typical
+ * difference is smaller by a factor of about sqrt(3 n).
+ */
+class FixedPointStatistics {
+public:
+    static constexpr std::int32_t kMaxVelocity = 100000;       // 1000 RPM in 0.01 RPM
+    static constexpr std::int32_t kMaxAcceleration = 1000000;  // 100000 RPM/s in 0.1 RPM/s
+    static constexpr std::int32_t kMaxMillivolts = 32767;      // Range of a frame voltage field
+    static constexpr std::int64_t kMaxProduct = static_cast<std::int64_t>(kMaxAcceleration) * kMaxAcceleration;
+    static constexpr std::uint32_t kMaxSamples = static_cast<std::uint32_t>(INT64_MAX / kMaxProduct);
+
+    /**
+     * @brief Create an empty accumulator
+     * @param source Voltage used as the response when adding frames
+     */
+    explicit FixedPointStatistics(VoltageSource source = VOLTAGE_COMMANDED) : voltageSource(source) {
+        clear();
+    }
+
+    /**
+     * @brief Reset to an empty sample set (the voltage source is kept)
+     */
+    void clear();
+
+    /**
+     * @brief Select the response used when adding frames
+     * @param source Commanded or measured applied voltage
+     */
+    void setVoltageSource(VoltageSource source) {
+        voltageSource = source;
+    }
+
+    /**
+     * @brief Add one sample in frame units
+     * @param velocity Velocity (0.01 RPM)
+     * @param acceleration Acceleration (0.1 RPM/s)
+     * @param millivolts Response voltage (mV)
+     * @return False if the sample was rejected by the overflow guard
+     */
+    bool add(std::int32_t velocity, std::int32_t acceleration, std::int32_t millivolts);
+
+    /**
+     * @brief Add a telemetry frame
+     *
+     * Follows SystemIdentification: faulted frames are skipped, and so are
+     * saturated frames when fitting against the commanded voltage.
+     *
+     * @param frame Frame to add
+     * @return False if the frame was skipped or rejected
+     */
+    bool add(const TelemetryFrame& frame);
+
+    /**
+     * @brief Add the sums of another, disjoint sample set
+     * @param other Accumulator to merge
+     * @return False if the merged count would exceed kMaxSamples (nothing is merged)
+     */
+    bool merge(const FixedPointStatistics& other);
+
+    /**
+     * @brief Convert the sums to physical units for solving
+     * @return Statistics in V, RPM and RPM/s
+     */
+    SufficientStatistics toStatistics() const;
+
+    /**
+     * @brief Solve a sub-model by least squares
+     * @param terms Bitmask of ModelTerm values to include
+     * @return Fit in V, RPM and RPM/s
+     */
+    StatisticsFit solve(std::uint32_t terms = TERM_ALL) const {
+        return toStatistics().solve(terms);
+    }
+
+    /**
+     * @brief First-order bound on how far rounding the readings moved a fit
+     * @param fit Fit returned by solve() with the same terms
+     * @param terms Terms the fit was solved with
+     * @return Bound per coefficient (kS, kV, kA); zero for terms not in the model
+     */
+    Eigen::Vector3d quantizationBound(const StatisticsFit& fit, std::uint32_t terms = TERM_ALL) const;
+
+    /**
+     * @brief Get the number of samples added
+     * @return Sample count
+     */
+    std::uint32_t getCount() const {
+        return count;
+    }
+
+    /**
+     * @brief Get the number of samples rejected by the overflow guard
+     * @return Rejected count
+     */
+    std::uint32_t getRejectedCount() const {
+        return rejected;
+    }
+
+private:
+    VoltageSource voltageSource;
+    std::int64_t gram[6];          // ss, sv, sa, vv, va, aa
+    std::int64_t crossProduct[3];  // sy, vy, ay
+    std::int64_t regressorSum[3];  // s, v, a
+    std::int64_t responseSumSquares;
+    std::int64_t responseSum;
+    std::uint32_t count;
+    std::uint32_t rejected;
+};
+
+} // namespace motor_characterization
+
+#endif // FIXED_POINT_STATISTICS_HPP
@@ -0,0 +1,196 @@
+#ifndef FREQUENCY_RESPONSE_HPP
+#define FREQUENCY_RESPONSE_HPP
+
+#include <cmath>
+#include <complex>
+#include <cstddef>
+#include <vector>
+
+namespace motor_characterization {
+
+/**
+ * @brief Voltage excitation for frequency response tests
+ *
+ * The signal rides on a positive offset so the motor never reverses: with
+ * sign(v) constant the static friction term is a constant and the rest of
+ * the model, V = kV v + kA a, is linear and has a transfer function.
+ */
+class ExcitationSignal {
+public:
+    /**
+     * @brief Multisine with Schroeder phases, scaled so its peak deviation is exactly peak
+     * @param frequencies Tone frequencies (Hz), ideally multiples of sampleRate / periodSamples
+     * @param offset Mean voltage (V)
+     * @param peak Largest deviation from the offset (V)
+     * @param sampleRate Samples per second
+     * @param periodSamples Samples per period of the signal
+     */
+    static ExcitationSignal multisine(const std::vector<double>& frequencies, double offset, double peak,
+                                      double sampleRate, std::size_t periodSamples);
+
+    /**
+     * @brief Voltage for a sample index
+     * @param sample Sample index (wraps at the period)
+     * @return Voltage (V)
+     */
+    double voltageAt(std::size_t sample) const;
+
+    /**
+     * @brief Get the number of samples in one period
+     * @return Period length
+     */
+    std::size_t getPeriodSamples() const {
+        return periodSamples;
+    }
+
+private:
+    struct Tone {
+        double frequency;  // rad per sample
+        double amplitude;
+        double phase;
+    };
+
+    ExcitationSignal(double offset, std::size_t periodSamples) : offset(offset), periodSamples(periodSamples) {}
+
+    double offset;
+    std::size_t periodSamples;
+    std::vector<Tone> tones;
+};
+
+/**
+ * @brief Streaming single-bin DFT (Goertzel recurrence)
+ *
+ * Two state variables per bin, one multiply-add per sample.
+ */
+class GoertzelBin {
+public:
+    GoertzelBin() : coefficient(0.0), omega(0.0), s1(0.0), s2(0.0) {}
+
+    /**
+     * @brief Set the bin frequency and clear the state
+     * @param frequency Frequency (Hz)
+     * @param sampleRate Samples per second
+     */
+    void configure(double frequency, double sampleRate);
+
+    /**
+     * @brief Feed one sample
+     * @param x Sample value
+     */
+    void add(double x) {
+        double s0 = x + coefficient * s1 - s2;
+        s2 = s1;
+        s1 = s0;
+    }
+
+    /**
+     * @brief Get the DFT value of the samples so far
+     *
+     * The result carries a phase factor that depends only on the sample
+     * count, so ratios of bins fed in lockstep are exact.
+     *
+     * @return Complex bin value
+     */
+    std::complex<double> result() const {
+        return std::complex<double>(s1 - s2 * std::cos(omega), s2 * std::sin(omega));
+    }
+
+private:
+    double coefficient;  // 2 cos(omega)
+    double omega;        // rad per sample
+    double s1;
+    double s2;
+};
+
+/**
+ * @brief Measured response at one frequency
+ */
+struct FrequencyPoint {
+    double frequency;                   // Hz
+    std::complex<double> response;      // Velocity / voltage (RPM/V)
+    double magnitude;                   // |response|
+    double phaseDegrees;
+};
+
+/**
+ * @brief kS, kV, kA and dead time fitted to a frequency response
+ */
+struct FrequencyResponseFit {
+    double kS;
+    double kV;
+    double kA;
+    double deadTime;        // s
+    double relativeError;   // RMS equation error / RMS voltage over the bins
+    bool valid;
+};
+
+/**
+ * @brief Frequency response of voltage -> velocity from streamed samples
+ *
+ * Keeps one Goertzel bin per frequency for voltage and one for velocity,
+ * plus the two means, so memory is O(bins) however long the test runs and
+ * no time series is stored.
+ */
+class FrequencyResponseEstimator {
+public:
+    /**
+     * @brief Create an estimator
+     * @param frequencies Frequencies to measure (Hz)
+     * @param sampleRate Samples per second (samples must be evenly spaced)
+     */
+    FrequencyResponseEstimator(const std::vector<double>& frequencies, double sampleRate);
+
+    /**
+     * @brief Feed one evenly spaced sample
+     * @param voltage Voltage (V)
+     * @param velocity Velocity (RPM)
+     */
+    void add(double voltage, double velocity);
+
+    /**
+     * @brief Get the response at each frequency
+     * @return One point per frequency
+     */
+    std::vector<FrequencyPoint> getResponse() const;
+
+    /**
+     * @brief Fit V = kS + (kV + j w kA) e^{j w tau} v to the measured bins
+     *
+     * For a fixed dead time tau the kV and kA columns are orthogonal, so each
+     * candidate costs O(bins); tau is searched on a 1 ms grid.
+     *
+     * @param maxDeadTime Largest dead time to consider (s)
+     * @return Fit; invalid if too few samples or bins
+     */
+    FrequencyResponseFit fit(double maxDeadTime = 0.1) const;
+
+    /**
+     * @brief Get the number of samples fed
+     * @return Sample count
+     */
+    std::size_t getSampleCount() const {
+        return sampleCount;
+    }
+
+    /**
+     * @brief Choose log-spaced frequencies snapped to the DFT grid of a record
+     * @param low Lowest frequency (Hz)
+     * @param high Highest frequency (Hz)
+     * @param count Number of frequencies requested (duplicates after snapping are dropped)
+     * @param recordSeconds Record length; frequencies become multiples of 1 / recordSeconds
+     * @return Increasing distinct frequencies
+     */
+    static std::vector<double> logFrequencies(double low, double high, std::size_t count, double recordSeconds);
+
+private:
+    std::vector<double> frequencies;
+    std::vector<GoertzelBin> voltageBins;
+    std::vector<GoertzelBin> velocityBins;
+    double voltageSum;
+    double velocitySum;
+    std::size_t sampleCount;
+};
+
+} // namespace motor_characterization
+
+#endif // FREQUENCY_RESPONSE_HPP
@@ -0,0 +1,112 @@
+#ifndef FRICTION_MODEL_HPP
+#define FRICTION_MODEL_HPP
+
+#include <cmath>
+#include <cstdint>
+#include "feedforward.hpp"
+#include "system_identification.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief Feedforward model with Coulomb, Stribeck and viscous friction
+ *
+ * V = F(v) + kV v + kA a, where for v > 0
+ *   F(v) = coulombForward + stribeckForward * exp(-(v / stribeckVelocity)^2)
+ * and for v < 0 the same with the reverse constants and a negative sign.
+ * The Stribeck term is the extra friction near standstill: breakaway
+ * friction is Coulomb plus Stribeck, decaying to Coulomb above a few
+ * stribeckVelocity. Forward and reverse friction are fitted separately,
+ * since wear is often one-sided.
+ */
+struct FrictionModel {
+    double coulombForward;      // Sliding friction (V)
+    double coulombReverse;      // Magnitude, reverse direction (V)
+    double stribeckForward;     // Breakaway friction above Coulomb (V)
+    double stribeckReverse;
+    double stribeckVelocity;    // Speed over which the Stribeck term decays (RPM)
+    double kV;                  // Viscous friction and back EMF (V/RPM)
+    double kA;                  // V/(RPM/s)
+    double velocityDeadband;    // Velocities within +/- this get no friction term (RPM)
+
+    FrictionModel()
+        : coulombForward(0.0), coulombReverse(0.0), stribeckForward(0.0), stribeckReverse(0.0),
+          stribeckVelocity(1.0), kV(0.0), kA(0.0), velocityDeadband(0.0) {}
+
+    /**
+     * @brief Calculate the feedforward voltage
+     *
+     * One division and one exp on top of the linear model, with the
+     * direction picked by comparisons as in frictionSign().
+     *
+     * @param velocity Velocity (RPM)
+     * @param acceleration Acceleration (RPM/s)
+     * @return Voltage (V)
+     */
+    double calculate(double velocity, double acceleration) const {
+        const double forward = velocity > velocityDeadband;
+        const double reverse = velocity < -velocityDeadband;
+        const double x = velocity / stribeckVelocity;
+        const double decay = std::exp(-x * x);
+        return forward * (coulombForward + stribeckForward * decay) -
+               reverse * (coulombReverse + stribeckReverse * decay) + kV * velocity + kA * acceleration;
+    }
+
+    /**
+     * @brief Get the friction at standstill
+     * @param forward True for the forward direction
+     * @return Breakaway friction magnitude (V)
+     */
+    double breakaway(bool forward) const {
+        return forward ? coulombForward + stribeckForward : coulombReverse + stribeckReverse;
+    }
+};
+
+/**
+ * @brief Result of a friction model fit
+ */
+struct FrictionModelFit {
+    FrictionModel model;
+    double rSquared;
+    double residualSumSquares;
+    double linearResidualSumSquares;  // Of the seed constants on the same samples
+    std::uint32_t samples;
+    int iterations;
+    bool valid;
+
+    FrictionModelFit()
+        : rSquared(0.0), residualSumSquares(0.0), linearResidualSumSquares(0.0), samples(0), iterations(0),
+          valid(false) {}
+};
+
+/**
+ * @brief Fit the friction model to a capture
+ *
+ * For a fixed Stribeck velocity the model is linear in its other six
+ * constants, so a coarse grid of Stribeck velocities is each solved
+ * exactly with a 6x6 system; with no Stribeck term the best of these is
+ * the linear model with separate forward and reverse kS. Gauss-Newton on
+ * all seven constants then refines from the best grid point, each
+ * iteration one pass over the samples into a fixed 7x7 system. A 20 s
+ * capture takes a few tens of passes in total.
+ *
+ * The fit needs samples in both directions. Like the regression it
+ * explains the voltage from the measured velocity and acceleration.
+ *
+ * @param sysId Capture (its voltage source is honoured)
+ * @param seed Linear constants the fit is compared against (and whose deadband it keeps)
+ * @param iterations Gauss-Newton iterations
+ * @return Fit; invalid if the capture does not cover both directions
+ */
+FrictionModelFit fitFrictionModel(const SystemIdentification& sysId, const FeedforwardConstants& seed,
+                                  int iterations = 8);
+
+/**
+ * @brief Print a friction model fit to the terminal
+ * @param fit Fit from fitFrictionModel()
+ */
+void printFrictionModel(const FrictionModelFit& fit);
+
+} // namespace motor_characterization
+
+#endif // FRICTION_MODEL_HPP
@@ -0,0 +1,144 @@
+#ifndef GROUP_IDENTIFICATION_HPP
+#define GROUP_IDENTIFICATION_HPP
+
+#include <cstdint>
+#include "sufficient_statistics.hpp"
+#include "system_identification.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief Largest motor group handled (a full V5 drivetrain side or lift)
+ */
+constexpr int kMaxGroupMembers = 8;
+
+/**
+ * @brief One tick of readings from every member of a motor group
+ */
+struct GroupSample {
+    double commanded;                         // Voltage commanded to the whole group (V)
+    double timestamp;                         // Time since the start of the step (s)
+    int members;
+    double velocity[kMaxGroupMembers];        // RPM
+    double acceleration[kMaxGroupMembers];    // RPM/s
+    double applied[kMaxGroupMembers];         // Voltage each member reports delivering (V)
+    double current[kMaxGroupMembers];         // A
+    bool saturated;                           // Any member could not deliver the command
+    std::uint32_t faults;                     // MotorFault bits of any member that exclude the sample
+
+    GroupSample() : commanded(0.0), timestamp(0.0), members(0), velocity(), acceleration(), applied(), current(),
+                    saturated(false), faults(FAULT_NONE) {}
+};
+
+/**
+ * @brief What one member contributes to the group
+ */
+struct GroupMemberResult {
+    StatisticsFit fit;          // Member's own kS, kV, kA against its own voltage
+    StatisticsFit currentFit;   // Member current: I = iS sign(v) + iV v + iA a (A, A/RPM, A/(RPM/s))
+    double meanCurrent;         // Mean |current| (A)
+    double share;               // Fraction of the group's total current carried by this member
+    double speedRatio;          // Mean |velocity| relative to the group mean
+    double dragScore;           // Largest relative excess over the group median (0 = typical)
+};
+
+/**
+ * @brief Identification of a coupled motor group and each of its members
+ *
+ * The combined mechanism is fitted as one equivalent motor (mean member
+ * velocity and acceleration against mean member voltage), which is what a
+ * feedforward for the group needs since every member gets the same command.
+ *
+ * Each member is also fitted on its own, for voltage and for current. A
+ * member whose friction voltage, current or current at zero speed is well
+ * above the median of the group, or which turns slower than the rest, is
+ * dragging the group. Everything is kept as SufficientStatistics, so
+ * memory does not grow with the length of the test.
+ */
+class GroupIdentification {
+public:
+    /**
+     * @brief Create an empty identification
+     * @param members Number of motors in the group (at most kMaxGroupMembers)
+     * @param dragThreshold Relative excess over the median that flags a member
+     */
+    explicit GroupIdentification(int members, double dragThreshold = 0.25);
+
+    /**
+     * @brief Select which voltage the fits are against
+     * @param source Commanded or measured applied voltage
+     */
+    void setVoltageSource(VoltageSource source) {
+        voltageSource = source;
+    }
+
+    /**
+     * @brief Add one tick of group readings
+     * @param sample Readings; skipped if faulted, or saturated when fitting against the commanded voltage
+     */
+    void add(const GroupSample& sample);
+
+    /**
+     * @brief Solve the combined and per-member fits
+     * @return True if the combined fit succeeded
+     */
+    bool identify();
+
+    /**
+     * @brief Get the fit of the group as one equivalent motor
+     * @return Combined fit
+     */
+    const StatisticsFit& getCombinedFit() const {
+        return combinedFit;
+    }
+
+    /**
+     * @brief Get a member's result
+     * @param member Index in the group's port order
+     * @return Result from the last identify()
+     */
+    const GroupMemberResult& getMember(int member) const {
+        return results[member];
+    }
+
+    /**
+     * @brief Get the number of members
+     * @return Member count
+     */
+    int getMemberCount() const {
+        return memberCount;
+    }
+
+    /**
+     * @brief Get the number of samples used
+     * @return Sample count
+     */
+    std::uint32_t getSampleCount() const {
+        return combined.getCount();
+    }
+
+    /**
+     * @brief Get the member dragging the group
+     * @return Member index, or -1 if no member exceeds the threshold
+     */
+    int getDraggingMember() const {
+        return draggingMember;
+    }
+
+private:
+    int memberCount;
+    double dragThreshold;
+    VoltageSource voltageSource;
+    SufficientStatistics combined;
+    SufficientStatistics voltageStatistics[kMaxGroupMembers];
+    SufficientStatistics currentStatistics[kMaxGroupMembers];
+    double absoluteCurrentSum[kMaxGroupMembers];
+    double absoluteSpeedSum[kMaxGroupMembers];
+    StatisticsFit combinedFit;
+    GroupMemberResult results[kMaxGroupMembers];
+    int draggingMember;
+};
+
+} // namespace motor_characterization
+
+#endif // GROUP_IDENTIFICATION_HPP
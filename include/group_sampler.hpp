@@ -0,0 +1,73 @@
+#ifndef GROUP_SAMPLER_HPP
+#define GROUP_SAMPLER_HPP
+
+#include "api.h"
+#include "fault_detector.hpp"
+#include "group_identification.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief Reads one sample per tick from every member of a motor group
+ *
+ * Uses the group's batch calls (get_actual_velocity_all,
+ * get_current_draw_all, get_voltage_all), so a tick costs one call per
+ * quantity however many motors the group has. Acceleration is a finite
+ * difference per member. Each member has its own FaultDetector fed from
+ * its current and speed, so a stalled member stops the run.
+ */
+class GroupSampler {
+public:
+    /**
+     * @brief Create a sampler for a group
+     * @param group Group to read (must outlive the sampler; members beyond kMaxGroupMembers are ignored)
+     */
+    explicit GroupSampler(pros::MotorGroup& group);
+
+    /**
+     * @brief Forget the previous sample, e.g. at the start of a new voltage step
+     */
+    void reset() {
+        previousTime = 0.0;
+    }
+
+    /**
+     * @brief Read every member for the current tick
+     * @param commandMillivolts Voltage currently commanded to the group with move_voltage
+     * @param time Time since the start of the step (s)
+     * @param sample Receives the readings
+     * @return True if a sample was produced (the first tick after reset only primes the differentiator)
+     */
+    bool sample(int commandMillivolts, double time, GroupSample& sample);
+
+    /**
+     * @brief Check whether the run should stop because a member faulted
+     * @return True once any member has stalled
+     */
+    bool shouldAbort() const;
+
+    /**
+     * @brief Get every fault seen on any member
+     * @return MotorFault bits
+     */
+    std::uint32_t getLatchedFaults() const;
+
+    /**
+     * @brief Get the number of members read
+     * @return Member count
+     */
+    int getMemberCount() const {
+        return memberCount;
+    }
+
+private:
+    pros::MotorGroup& group;
+    int memberCount;
+    double previousTime;
+    double previousVelocity[kMaxGroupMembers];
+    FaultDetector detectors[kMaxGroupMembers];
+};
+
+} // namespace motor_characterization
+
+#endif // GROUP_SAMPLER_HPP
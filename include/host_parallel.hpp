@@ -0,0 +1,50 @@
+#ifndef HOST_PARALLEL_HPP
+#define HOST_PARALLEL_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// The analysis code also runs on desktop builds for offline processing of
+// captures. Those have threads; the V5 brain has a single core, so there the
+// work simply runs in order on the calling task.
+#if defined(__unix__) || defined(__APPLE__) || defined(_WIN32)
+#define MOTOR_CHARACTERIZATION_HOST_THREADS 1
+#include <thread>
+#endif
+
+namespace motor_characterization {
+
+/**
+ * @brief Run body(i) for every i in [0, count), in parallel where threads exist
+ *
+ * Iterations are split into contiguous chunks, one per hardware thread.
+ * Bodies must only write to state owned by their own index.
+ *
+ * @param count Number of iterations
+ * @param body Callable taking the iteration index
+ */
+template <typename Body>
+void parallelFor(std::size_t count, Body&& body) {
+#if defined(MOTOR_CHARACTERIZATION_HOST_THREADS)
+    std::size_t threadCount = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), count);
+    if (threadCount > 1) {
+        std::vector<std::thread> threads;
+        threads.reserve(threadCount);
+        for (std::size_t t = 0; t < threadCount; ++t) {
+            std::size_t begin = count * t / threadCount;
+            std::size_t end = count * (t + 1) / threadCount;
+            threads.emplace_back([&body, begin, end] {
+                for (std::size_t i = begin; i < end; ++i) body(i);
+            });
+        }
+        for (auto& thread : threads) thread.join();
+        return;
+    }
+#endif
+    for (std::size_t i = 0; i < count; ++i) body(i);
+}
+
+} // namespace motor_characterization
+
+#endif // HOST_PARALLEL_HPP
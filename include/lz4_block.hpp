@@ -0,0 +1,67 @@
+#ifndef LZ4_BLOCK_HPP
+#define LZ4_BLOCK_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace motor_characterization {
+
+/**
+ * @brief Minimal LZ4 block-format codec
+ *
+ * The LZ4 sources vendored with LVGL are compiled out of liblvgl.a
+ * (LV_USE_LZ4_INTERNAL is 0), so this implements the plain LZ4 block format
+ * directly. Output is readable by any standard LZ4_decompress_safe, which
+ * lets host tools use the reference library on logs copied off the SD card.
+ *
+ * Blocks are limited to 64 KiB so match positions fit in 16 bits, keeping
+ * the hash table at 8 KiB.
+ */
+class Lz4BlockCodec {
+public:
+    static constexpr std::size_t kMaxBlockSize = 65535;
+
+    Lz4BlockCodec() : hashTable(kHashTableSize) {}
+
+    /**
+     * @brief Worst-case compressed size for an input of the given size
+     * @param inputSize Number of input bytes
+     * @return Required output capacity
+     */
+    static constexpr std::size_t compressBound(std::size_t inputSize) {
+        return inputSize + inputSize / 255 + 16;
+    }
+
+    /**
+     * @brief Compress one block
+     * @param src Input bytes
+     * @param srcSize Number of input bytes (at most kMaxBlockSize)
+     * @param dst Output buffer
+     * @param dstCapacity Output capacity (compressBound(srcSize) always suffices)
+     * @return Compressed size, or 0 if the block does not fit
+     */
+    std::size_t compress(const std::uint8_t* src, std::size_t srcSize,
+                         std::uint8_t* dst, std::size_t dstCapacity);
+
+    /**
+     * @brief Decompress one block with full bounds checking
+     * @param src Compressed bytes
+     * @param srcSize Number of compressed bytes
+     * @param dst Output buffer
+     * @param dstCapacity Output capacity
+     * @return Decompressed size, or -1 if the input is malformed
+     */
+    static long decompress(const std::uint8_t* src, std::size_t srcSize,
+                           std::uint8_t* dst, std::size_t dstCapacity);
+
+private:
+    static constexpr int kHashLog = 12;
+    static constexpr std::size_t kHashTableSize = std::size_t(1) << kHashLog;
+
+    std::vector<std::uint16_t> hashTable;
+};
+
+} // namespace motor_characterization
+
+#endif // LZ4_BLOCK_HPP
@@ -0,0 +1,51 @@
+#ifndef MODEL_SELECTION_HPP
+#define MODEL_SELECTION_HPP
+
+#include <cstdint>
+#include <vector>
+#include "sufficient_statistics.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief One candidate model in a model selection table
+ */
+struct ModelCandidate {
+    std::uint32_t terms;        // ModelTerm bitmask
+    char name[16];              // e.g. "S+V+A"
+    int parameters;
+    StatisticsFit fit;
+    double adjustedRSquared;
+    double aic;                 // Akaike information criterion (lower is better)
+    double bic;                 // Bayesian information criterion (lower is better)
+    double deltaBic;            // BIC minus the best BIC in the table
+};
+
+/**
+ * @brief Fit every sub-model from one set of sufficient statistics and rank them
+ *
+ * Candidates are all term combinations that include velocity (V, S+V, V+A,
+ * S+V+A for the current terms), each solved from the shared Gram matrix, so
+ * the cost is one data pass plus a few 3x3 solves. Invalid (unidentifiable)
+ * candidates are kept at the end of the table with fit.valid false.
+ *
+ * Information criteria assume independent samples. Residuals sampled at
+ * 100 Hz are correlated, which overstates the evidence for extra terms;
+ * pass the effective sample count (ParameterUncertainty::effectiveSamples)
+ * to compensate.
+ *
+ * @param statistics Statistics of the capture
+ * @param effectiveSamples Sample count used by AIC/BIC, or 0 for the raw count
+ * @return Candidates sorted by BIC, best first
+ */
+std::vector<ModelCandidate> selectModels(const SufficientStatistics& statistics, double effectiveSamples = 0.0);
+
+/**
+ * @brief Print a model selection table to the terminal
+ * @param candidates Table from selectModels()
+ */
+void printModelTable(const std::vector<ModelCandidate>& candidates);
+
+} // namespace motor_characterization
+
+#endif // MODEL_SELECTION_HPP
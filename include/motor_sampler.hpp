@@ -0,0 +1,161 @@
+#ifndef MOTOR_SAMPLER_HPP
+#define MOTOR_SAMPLER_HPP
+
+#include "api.h"
+#include "fault_detector.hpp"
+#include "fixed_point_statistics.hpp"
+#include "state_estimator.hpp"
+#include "system_identification.hpp"
+#include "telemetry_sampler.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief Reads one characterization sample per tick from a motor
+ *
+ * Besides velocity (and acceleration by finite difference) every sample
+ * records the voltage the motor reports delivering and the battery voltage,
+ * so identification can regress on what was actually applied instead of
+ * what was commanded, and flag samples where the command was out of reach.
+ *
+ * Every tick also polls the motor's fault bits, flags and current draw
+ * through a FaultDetector. Samples taken during current limiting are marked
+ * so identification skips them, and shouldAbort() turns true on the tick a
+ * stall, over-temperature or driver fault is recognized.
+ *
+ * With a MotorStateEstimator attached, velocity and acceleration come from
+ * the filter (fusing the encoder position, the velocity reading and the
+ * command) and each sample carries the filter's variances for weighting.
+ *
+ * All readings go through a TelemetrySampler, so the tick reads only the
+ * channels identification needs plus any extra ones enabled for logging,
+ * and the last tick is also available as a packed TelemetryFrame.
+ * Frames can also be accumulated straight into FixedPointStatistics on
+ * the sampling tick.
+ */
+class MotorSampler {
+public:
+    static constexpr double kSaturationHeadroom = 0.5;   // V the battery must exceed the command by
+    static constexpr double kSaturationTolerance = 0.5;  // V the applied voltage may differ from the command
+
+    // Channels every sample needs; position is added with a state estimator
+    static constexpr std::uint32_t kRequiredChannels = TELEMETRY_VELOCITY | TELEMETRY_APPLIED_VOLTAGE |
+                                                       TELEMETRY_BATTERY_VOLTAGE | TELEMETRY_CURRENT |
+                                                       TELEMETRY_FAULTS;
+
+    /**
+     * @brief Create a sampler for a motor
+     * @param motor Motor to read (must outlive the sampler)
+     * @param faultOptions Fault detection thresholds
+     */
+    explicit MotorSampler(pros::Motor& motor, const FaultDetectorOptions& faultOptions = FaultDetectorOptions())
+        : motor(motor), telemetry(motor, kRequiredChannels), extraChannels(0), fixedPoint(nullptr),
+          estimator(nullptr), estimatorMicros(0), detector(faultOptions) {
+        reset();
+    }
+
+    /**
+     * @brief Forget the previous sample, e.g. at the start of a new voltage step
+     */
+    void reset() {
+        previousVelocity = 0.0;
+        previousTime = 0.0;
+    }
+
+    /**
+     * @brief Filter velocity and acceleration through a state estimator
+     *
+     * Switches the motor's encoder to degrees, the unit the estimator expects.
+     * The estimator keeps its own clock and is not cleared by reset(): it
+     * carries its state across voltage steps and sees each step through the
+     * commanded voltage.
+     *
+     * @param stateEstimator Estimator to use (must outlive the sampler), or nullptr for raw differences
+     */
+    void setStateEstimator(MotorStateEstimator* stateEstimator);
+
+    /**
+     * @brief Read more channels than identification needs, e.g. for logging
+     * @param channels Bitmask of TelemetryChannel values read on top of the required ones
+     */
+    void setExtraChannels(std::uint32_t channels);
+
+    /**
+     * @brief Accumulate every sampled frame into integer statistics
+     * @param statistics Accumulator (must outlive the sampler), or nullptr to stop
+     */
+    void setFixedPointStatistics(FixedPointStatistics* statistics) {
+        fixedPoint = statistics;
+    }
+
+    /**
+     * @brief Read the motor and battery for the current tick
+     * @param commandMillivolts Voltage currently commanded with move_voltage
+     * @param time Time since the start of the step (s)
+     * @param point Receives the sample
+     * @return True if a sample was produced (the first tick after reset only primes the differentiator)
+     */
+    bool sample(int commandMillivolts, double time, DataPoint& point);
+
+    /**
+     * @brief Check whether the run should stop because of a fault
+     * @return True once a stall, over-temperature or driver fault has been seen
+     */
+    bool shouldAbort() const {
+        return detector.shouldAbort();
+    }
+
+    /**
+     * @brief Get the fault detector
+     * @return Detector with the faults latched so far
+     */
+    const FaultDetector& getFaultDetector() const {
+        return detector;
+    }
+
+    /**
+     * @brief Get the frame of the last sample()
+     * @return Frame with every enabled channel, the command, acceleration, faults and status
+     */
+    const TelemetryFrame& getFrame() const {
+        return frame;
+    }
+
+    /**
+     * @brief Get the time spent reading telemetry
+     * @return Read cost since the sampler was created
+     */
+    TelemetryCost getTelemetryCost() const {
+        return telemetry.getCost();
+    }
+
+    /**
+     * @brief Decide whether a commanded voltage was out of reach
+     * @param commanded Commanded voltage (V)
+     * @param applied Voltage the motor reports delivering (V)
+     * @param battery Battery voltage (V, 0 if unknown)
+     * @return True if the sample should be treated as saturated
+     */
+    static bool isSaturated(double commanded, double applied, double battery);
+
+private:
+    /**
+     * @brief Update the telemetry channel mask from the estimator and extra channels
+     */
+    void updateChannels();
+
+    pros::Motor& motor;
+    TelemetrySampler telemetry;
+    TelemetryFrame frame;
+    std::uint32_t extraChannels;
+    FixedPointStatistics* fixedPoint;
+    MotorStateEstimator* estimator;
+    std::uint64_t estimatorMicros;
+    FaultDetector detector;
+    double previousVelocity;
+    double previousTime;
+};
+
+} // namespace motor_characterization
+
+#endif // MOTOR_SAMPLER_HPP
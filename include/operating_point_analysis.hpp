@@ -0,0 +1,105 @@
+#ifndef OPERATING_POINT_ANALYSIS_HPP
+#define OPERATING_POINT_ANALYSIS_HPP
+
+#include <cstdint>
+#include <vector>
+#include "sufficient_statistics.hpp"
+#include "system_identification.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief Local fit of one profile segment or velocity band
+ */
+struct LocalFit {
+    double lower;               // Segment: commanded voltage; band: lowest |velocity| (RPM)
+    double upper;               // Segment: commanded voltage; band: highest |velocity| (RPM)
+    double meanSpeed;           // Mean |velocity| of the samples (RPM)
+    std::uint32_t samples;
+    double kS;
+    double kV;
+    double kSError;             // Standard errors (independent-residual approximation)
+    double kVError;
+    double rSquared;
+    bool valid;                 // False if kS and kV are not separable from these samples
+};
+
+/**
+ * @brief Local kS and kV per profile segment and per velocity band
+ *
+ * A single global fit averages over the operating range; friction from worn
+ * bearings shows up mostly at low speed and gets hidden by the high-voltage
+ * steps. This analysis splits one capture two ways, by profile segment (a
+ * run of samples with the same commanded voltage) and by |velocity| band,
+ * and fits each group on its own.
+ *
+ * All groups are accumulated in one pass over the samples: the capture is
+ * cut into chunks that are reduced in parallel on desktop builds and merged.
+ * kA is held at the global estimate for the local fits, since within one
+ * step the acceleration is almost a linear combination of sign(v) and v
+ * and cannot be separated locally.
+ */
+class OperatingPointAnalysis {
+public:
+    /**
+     * @brief Analyze a capture
+     * @param sysId Identification object holding the samples (its voltage source is honoured)
+     * @param bandEdges Increasing |velocity| band edges (RPM); samples below the first edge are not banded
+     */
+    explicit OperatingPointAnalysis(const SystemIdentification& sysId,
+                                    const std::vector<double>& bandEdges = {5, 25, 50, 100, 150, 200, 300, 450, 650});
+
+    /**
+     * @brief Get the per-segment fits in profile order
+     * @return One entry per segment
+     */
+    const std::vector<LocalFit>& getSegments() const {
+        return segments;
+    }
+
+    /**
+     * @brief Get the per-band fits in increasing speed
+     * @return One entry per band
+     */
+    const std::vector<LocalFit>& getBands() const {
+        return bands;
+    }
+
+    /**
+     * @brief Get the global fit used to fix kA
+     * @return Fit over all samples
+     */
+    const StatisticsFit& getGlobalFit() const {
+        return globalFit;
+    }
+
+    /**
+     * @brief Print both tables to the terminal
+     */
+    void printTables() const;
+
+private:
+    struct GroupAccumulator {
+        SufficientStatistics statistics;
+        double speedSum = 0.0;
+
+        GroupAccumulator& operator+=(const GroupAccumulator& other) {
+            statistics += other.statistics;
+            speedSum += other.speedSum;
+            return *this;
+        }
+    };
+
+    /**
+     * @brief Fit kS and kV for one group with kA held at the global value
+     */
+    LocalFit solveGroup(const GroupAccumulator& group, double lower, double upper) const;
+
+    StatisticsFit globalFit;
+    std::vector<LocalFit> segments;
+    std::vector<LocalFit> bands;
+};
+
+} // namespace motor_characterization
+
+#endif // OPERATING_POINT_ANALYSIS_HPP
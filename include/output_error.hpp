@@ -0,0 +1,83 @@
+#ifndef OUTPUT_ERROR_HPP
+#define OUTPUT_ERROR_HPP
+
+#include <Eigen/Dense>
+#include "feedforward.hpp"
+#include "system_identification.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief Settings of an output-error refinement
+ */
+struct OutputErrorOptions {
+    int maxIterations;          // Levenberg-Marquardt iterations
+    double tolerance;           // Stop when the relative drop in squared error is below this
+    double initialDamping;      // Starting Marquardt damping, relative to the diagonal
+
+    OutputErrorOptions() : maxIterations(10), tolerance(1e-6), initialDamping(1e-3) {}
+};
+
+/**
+ * @brief Result of an output-error refinement
+ */
+struct OutputErrorFit {
+    FeedforwardConstants constants;
+    Eigen::Vector3d standardError;  // kS, kV, kA (independent-residual approximation)
+    double initialRms;              // Velocity prediction error of the seed (RPM)
+    double finalRms;                // Velocity prediction error of the result (RPM)
+    std::uint32_t samples;
+    int iterations;
+    bool valid;
+
+    OutputErrorFit()
+        : standardError(Eigen::Vector3d::Zero()), initialRms(0.0), finalRms(0.0), samples(0), iterations(0),
+          valid(false) {}
+};
+
+/**
+ * @brief Refine the feedforward constants by simulating the motor's velocity
+ *
+ * The regression is an equation-error fit: it explains the voltage from the
+ * measured velocity and acceleration, and the noise on those regressors
+ * (the acceleration especially) biases kV and kA towards zero. Here the
+ * model dv/dt = (V - kS sign(v) - kV v) / kA is instead simulated under the
+ * recorded voltage and the constants are chosen to minimize the error of
+ * the simulated velocity, where the measurement noise only enters the
+ * output.
+ *
+ * Between samples the voltage and friction sign are constant, so each step
+ * uses the exact first-order solution. The derivatives of the simulated
+ * velocity with respect to kS, kV and kA are propagated alongside it by
+ * differentiating that step, so every Levenberg-Marquardt iteration is a
+ * single O(N) pass accumulating a 3x3 system. A velocity that would cross
+ * zero against a voltage below kS sticks at zero, as the motor does.
+ *
+ * The simulated output is only as good as the seed is close, so the
+ * refinement starts from the least squares constants and usually settles
+ * in a few iterations.
+ */
+class OutputErrorRefinement {
+public:
+    /**
+     * @brief Refine constants on a capture
+     * @param sysId Capture (its voltage source selects the simulated voltage; ideally dead-time aligned)
+     * @param seed Starting constants, normally the regression result
+     * @param options Iteration settings
+     * @return Refined constants; invalid if the seed cannot be simulated
+     */
+    static OutputErrorFit refine(const SystemIdentification& sysId, const FeedforwardConstants& seed,
+                                 const OutputErrorOptions& options = OutputErrorOptions());
+
+    /**
+     * @brief Get the velocity prediction error of a set of constants
+     * @param sysId Capture
+     * @param constants Constants to simulate
+     * @return RMS velocity error (RPM), infinite if the constants cannot be simulated
+     */
+    static double simulationError(const SystemIdentification& sysId, const FeedforwardConstants& constants);
+};
+
+} // namespace motor_characterization
+
+#endif // OUTPUT_ERROR_HPP
@@ -0,0 +1,100 @@
+#ifndef RESAMPLING_HPP
+#define RESAMPLING_HPP
+
+#include <cstdint>
+#include <vector>
+#include "sufficient_statistics.hpp"
+#include "system_identification.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief Result of k-fold cross-validation
+ */
+struct CrossValidationResult {
+    int folds;
+    double outOfSampleRSquared;  // 1 - PRESS / total sum of squares
+    double rootMeanSquareError;  // Out-of-sample prediction error (V)
+    bool valid;
+
+    CrossValidationResult() : folds(0), outOfSampleRSquared(0.0), rootMeanSquareError(0.0), valid(false) {}
+};
+
+/**
+ * @brief Result of a block bootstrap
+ */
+struct BootstrapResult {
+    int replicates;               // Replicates with a valid fit
+    double confidenceLevel;
+    Eigen::Vector3d mean;         // kS, kV, kA
+    Eigen::Vector3d standardError;
+    Eigen::Vector3d lower;        // Percentile confidence interval
+    Eigen::Vector3d upper;
+
+    BootstrapResult()
+        : replicates(0), confidenceLevel(0.0), mean(Eigen::Vector3d::Zero()), standardError(Eigen::Vector3d::Zero()),
+          lower(Eigen::Vector3d::Zero()), upper(Eigen::Vector3d::Zero()) {}
+};
+
+/**
+ * @brief Cross-validation and bootstrap from per-block sufficient statistics
+ *
+ * The capture is cut into contiguous blocks of samples and each block is
+ * reduced to its SufficientStatistics once. Folds and bootstrap replicates
+ * are then assembled by adding block statistics, so each one costs
+ * O(blocks * p^2) instead of a pass over every sample. Keeping blocks
+ * contiguous preserves the short-range correlation of the residuals, which
+ * an ordinary per-sample bootstrap would destroy.
+ */
+class BlockResampler {
+public:
+    /**
+     * @brief Reduce a capture to block statistics
+     * @param sysId Identification object holding the samples (its voltage source is honoured)
+     * @param blockLength Samples per block (the last block may be shorter)
+     */
+    explicit BlockResampler(const SystemIdentification& sysId, std::size_t blockLength = 50);
+
+    /**
+     * @brief K-fold cross-validation over contiguous groups of blocks
+     * @param folds Number of folds
+     * @param terms Model terms (ModelTerm bitmask)
+     * @return Out-of-sample fit quality
+     */
+    CrossValidationResult crossValidate(int folds = 5, std::uint32_t terms = TERM_ALL) const;
+
+    /**
+     * @brief Block bootstrap of the constants (whole blocks drawn with replacement)
+     * @param replicates Number of resampled fits
+     * @param confidenceLevel Level of the percentile intervals
+     * @param seed Random seed (results are reproducible for a given seed)
+     * @param terms Model terms (ModelTerm bitmask)
+     * @return Bootstrap distribution summary
+     */
+    BootstrapResult bootstrap(int replicates = 1000, double confidenceLevel = 0.95, std::uint32_t seed = 1,
+                              std::uint32_t terms = TERM_ALL) const;
+
+    /**
+     * @brief Get the per-block statistics
+     * @return Statistics of each block in capture order
+     */
+    const std::vector<SufficientStatistics>& getBlocks() const {
+        return blocks;
+    }
+
+    /**
+     * @brief Get the statistics of the whole capture
+     * @return Sum of all blocks
+     */
+    const SufficientStatistics& getTotal() const {
+        return total;
+    }
+
+private:
+    std::vector<SufficientStatistics> blocks;
+    SufficientStatistics total;
+};
+
+} // namespace motor_characterization
+
+#endif // RESAMPLING_HPP
@@ -0,0 +1,153 @@
+#ifndef RUNNING_STATISTICS_HPP
+#define RUNNING_STATISTICS_HPP
+
+#include <cstdint>
+#include "feedforward.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief Streaming mean, variance and range of one quantity
+ *
+ * Uses Welford's update, which keeps the sum of squared deviations from the
+ * running mean instead of the raw sum of squares, so the variance does not
+ * lose its digits to cancellation when the spread is small next to the
+ * mean (typical for kV across runs). Two accumulators over disjoint samples
+ * combine exactly with the pairwise formula of Chan et al., so partial
+ * results from runs, motors or threads can be merged in any order.
+ */
+class RunningStatistics {
+public:
+    RunningStatistics() {
+        clear();
+    }
+
+    /**
+     * @brief Forget all samples
+     */
+    void clear();
+
+    /**
+     * @brief Add one sample
+     * @param value Sample; non-finite values are ignored
+     */
+    void add(double value);
+
+    /**
+     * @brief Merge the statistics of another, disjoint sample set
+     * @param other Statistics to merge
+     * @return This object
+     */
+    RunningStatistics& operator+=(const RunningStatistics& other);
+
+    /**
+     * @brief Get the number of samples
+     * @return Sample count
+     */
+    std::uint32_t getCount() const {
+        return count;
+    }
+
+    /**
+     * @brief Get the mean
+     * @return Mean, 0 without samples
+     */
+    double getMean() const {
+        return mean;
+    }
+
+    /**
+     * @brief Get the sample variance (n - 1 denominator)
+     * @return Variance, 0 with fewer than two samples
+     */
+    double getVariance() const {
+        return count > 1 ? squaredDeviations / (count - 1) : 0.0;
+    }
+
+    /**
+     * @brief Get the population variance (n denominator)
+     * @return Variance, 0 without samples
+     */
+    double getPopulationVariance() const {
+        return count > 0 ? squaredDeviations / count : 0.0;
+    }
+
+    /**
+     * @brief Get the sample standard deviation
+     * @return Standard deviation
+     */
+    double getStdDev() const;
+
+    /**
+     * @brief Get the coefficient of variation
+     * @return Standard deviation over |mean|, infinite if the mean is zero
+     */
+    double getCoefficientOfVariation() const;
+
+    /**
+     * @brief Get the smallest sample
+     * @return Minimum, 0 without samples
+     */
+    double getMin() const {
+        return count > 0 ? minimum : 0.0;
+    }
+
+    /**
+     * @brief Get the largest sample
+     * @return Maximum, 0 without samples
+     */
+    double getMax() const {
+        return count > 0 ? maximum : 0.0;
+    }
+
+private:
+    std::uint32_t count;
+    double mean;
+    double squaredDeviations;  // Sum of squared deviations from the mean
+    double minimum;
+    double maximum;
+};
+
+/**
+ * @brief Running statistics of each feedforward constant over repeated fits
+ */
+struct FeedforwardStatistics {
+    RunningStatistics kS;
+    RunningStatistics kV;
+    RunningStatistics kA;
+
+    /**
+     * @brief Add the constants of one fit
+     * @param constants Fitted constants
+     */
+    void add(const FeedforwardConstants& constants) {
+        kS.add(constants.kS);
+        kV.add(constants.kV);
+        kA.add(constants.kA);
+    }
+
+    /**
+     * @brief Merge the statistics of another, disjoint set of fits
+     * @param other Statistics to merge
+     * @return This object
+     */
+    FeedforwardStatistics& operator+=(const FeedforwardStatistics& other) {
+        kS += other.kS;
+        kV += other.kV;
+        kA += other.kA;
+        return *this;
+    }
+
+    /**
+     * @brief Get the statistics of one constant by index
+     * @param term 0 for kS, 1 for kV, 2 for kA
+     * @return Statistics
+     */
+    const RunningStatistics& operator[](int term) const {
+        return term == 0 ? kS : term == 1 ? kV : kA;
+    }
+};
+
+} // namespace motor_characterization
+
+#endif // RUNNING_STATISTICS_HPP
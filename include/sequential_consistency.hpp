@@ -0,0 +1,149 @@
+#ifndef SEQUENTIAL_CONSISTENCY_HPP
+#define SEQUENTIAL_CONSISTENCY_HPP
+
+#include <cstdint>
+#include "feedforward.hpp"
+#include "running_statistics.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief Stopping rules of a repeated-run consistency test
+ *
+ * Widths and limits are relative to the mean of each constant, in the
+ * order kS, kV, kA.
+ */
+struct ConsistencyOptions {
+    int minRuns;                    // Successful runs before any stop is considered (at least 2)
+    int maxRuns;                    // Runs attempted before giving up, failed runs included
+    double targetHalfWidth[3];      // 95% confidence half-width of the mean that counts as pinned down
+    double inconsistentSpread[3];   // Run-to-run CV that counts as clearly inconsistent
+    int minRunsToReject;            // Successful runs before the inconsistency check
+
+    ConsistencyOptions()
+        : minRuns(2), maxRuns(8), targetHalfWidth{0.10, 0.03, 0.25}, inconsistentSpread{0.20, 0.20, 0.30},
+          minRunsToReject(3) {}
+};
+
+/**
+ * @brief Where a consistency test stands after its latest run
+ */
+enum ConsistencyDecision {
+    CONSISTENCY_CONTINUE,      // Run again
+    CONSISTENCY_CONVERGED,     // Every constant's interval is within its target
+    CONSISTENCY_INCONSISTENT,  // A constant's spread is confidently beyond its limit
+    CONSISTENCY_RUN_LIMIT      // Out of runs before either
+};
+
+/**
+ * @brief Sequential stopping rule for repeated characterization runs
+ *
+ * After each run the t-interval of every constant's mean is compared with
+ * its target width; once all are narrow enough there is nothing to gain
+ * from more runs. A motor that repeats well therefore stops after two or
+ * three runs, while a noisy one keeps going until the intervals close or
+ * the run limit is hit.
+ *
+ * The opposite stop uses a one-sided 95% lower confidence bound on each
+ * standard deviation (from the chi-square distribution of the sample
+ * variance): when even that bound puts the coefficient of variation past
+ * the inconsistency limit, more runs would only confirm a bad motor.
+ *
+ * Checking after every run inflates the error rates somewhat compared with
+ * a single test at a fixed count; with a handful of runs this is small
+ * next to the run-to-run drift the test is looking for.
+ */
+class SequentialConsistency {
+public:
+    /**
+     * @brief Create a test with no runs
+     * @param options Stopping rules
+     */
+    explicit SequentialConsistency(const ConsistencyOptions& options = ConsistencyOptions());
+
+    /**
+     * @brief Record a successful run
+     * @param constants Constants fitted by the run
+     * @return Decision after this run
+     */
+    ConsistencyDecision addRun(const FeedforwardConstants& constants);
+
+    /**
+     * @brief Record a run that could not be identified
+     * @return Decision after this run
+     */
+    ConsistencyDecision addFailedRun();
+
+    /**
+     * @brief Get the decision after the latest run
+     * @return Decision
+     */
+    ConsistencyDecision getDecision() const {
+        return decision;
+    }
+
+    /**
+     * @brief Get the statistics of the successful runs
+     * @return Statistics per constant
+     */
+    const FeedforwardStatistics& getStatistics() const {
+        return statistics;
+    }
+
+    /**
+     * @brief Get the number of runs recorded
+     * @return Runs, failed runs included
+     */
+    int getRunCount() const {
+        return runCount;
+    }
+
+    /**
+     * @brief Get the number of successful runs
+     * @return Successful runs
+     */
+    int getSuccessfulRuns() const {
+        return static_cast<int>(statistics.kS.getCount());
+    }
+
+    /**
+     * @brief Get the run limit
+     * @return Most runs the test will ask for
+     */
+    int getMaxRuns() const {
+        return options.maxRuns;
+    }
+
+    /**
+     * @brief Get the 95% confidence half-width of a constant's mean, relative to the mean
+     * @param term 0 for kS, 1 for kV, 2 for kA
+     * @return Relative half-width, infinite with fewer than two runs or a zero mean
+     */
+    double relativeHalfWidth(int term) const;
+
+    /**
+     * @brief Get the one-sided 95% lower confidence bound of a constant's coefficient of variation
+     * @param term 0 for kS, 1 for kV, 2 for kA
+     * @return Lower bound, 0 with fewer than two runs
+     */
+    double spreadLowerBound(int term) const;
+
+    /**
+     * @brief Get a short name for a decision
+     * @param decision Decision
+     * @return Name
+     */
+    static const char* describe(ConsistencyDecision decision);
+
+private:
+    ConsistencyDecision decide() const;
+
+    ConsistencyOptions options;
+    FeedforwardStatistics statistics;
+    int runCount;
+    ConsistencyDecision decision;
+};
+
+} // namespace motor_characterization
+
+#endif // SEQUENTIAL_CONSISTENCY_HPP
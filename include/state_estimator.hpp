@@ -0,0 +1,150 @@
+#ifndef STATE_ESTIMATOR_HPP
+#define STATE_ESTIMATOR_HPP
+
+#include <Eigen/Dense>
+
+namespace motor_characterization {
+
+/**
+ * @brief Noise and input settings of the motor state estimator
+ */
+struct StateEstimatorOptions {
+    double positionNoise;        // Standard deviation of get_position (deg)
+    double velocityNoise;        // Standard deviation of get_actual_velocity (RPM)
+    double jerkNoise;            // Square root of the white jerk spectral density (RPM/s^2/sqrt(Hz))
+    double initialAcceleration;  // Standard deviation of the acceleration when the filter starts (RPM/s)
+    double accelerationPerVolt;  // Expected acceleration jump per volt of command change (RPM/s/V)
+    double timeConstant;         // Decay time of the acceleration after a step (s, 0 for constant acceleration)
+    bool shiftAcceleration;      // Also move the acceleration estimate by the expected jump
+
+    StateEstimatorOptions(double position = 1.0, double velocity = 5.0, double jerk = 1000.0,
+                          double acceleration = 2000.0, double perVolt = 300.0, double tau = 0.0,
+                          bool shift = false)
+        : positionNoise(position), velocityNoise(velocity), jerkNoise(jerk), initialAcceleration(acceleration),
+          accelerationPerVolt(perVolt), timeConstant(tau), shiftAcceleration(shift) {}
+};
+
+/**
+ * @brief Kalman filter for motor position, velocity and acceleration
+ *
+ * Fuses the encoder position and the motor's velocity reading. By default
+ * the process model is constant acceleration plus white jerk noise. The
+ * commanded voltage enters as a known input: a change of command widens the
+ * acceleration variance by accelerationPerVolt times the change, so the
+ * filter follows voltage steps without a large jerk noise smoothing
+ * everything else.
+ *
+ * A DC motor's acceleration decays exponentially under a constant voltage,
+ * and a nonzero timeConstant models that (a Singer model); shiftAcceleration
+ * also moves the acceleration by the expected jump on a command change.
+ * Both are a prior on the motor being identified: the filtered acceleration
+ * leans towards the assumed time constant and jump, which biases kA and kV
+ * from the regression towards kA / kV = timeConstant and kA = 1 /
+ * accelerationPerVolt. Only enable them with values from a previous fit of
+ * the same motor.
+ *
+ * State units are deg, RPM and RPM/s. Everything is fixed-size and the two
+ * measurements are applied as sequential scalar updates, so a step costs a
+ * few hundred flops and never allocates.
+ */
+class MotorStateEstimator {
+public:
+    explicit MotorStateEstimator(const StateEstimatorOptions& options = StateEstimatorOptions())
+        : options(options) {
+        reset();
+    }
+
+    /**
+     * @brief Forget the state; the next update initializes from its measurements
+     */
+    void reset() {
+        state.setZero();
+        covariance.setZero();
+        command = 0.0;
+        initialized = false;
+    }
+
+    /**
+     * @brief Advance the filter by one sample
+     * @param dt Time since the previous update (s); ignored on the first update
+     * @param commandedVoltage Voltage commanded over the interval since the previous update (V)
+     * @param position Encoder position (deg); non-finite values are skipped
+     * @param velocity Velocity reading (RPM); non-finite values are skipped
+     */
+    void update(double dt, double commandedVoltage, double position, double velocity);
+
+    /**
+     * @brief Check whether the filter has been initialized from a measurement
+     * @return True after the first update
+     */
+    bool isInitialized() const {
+        return initialized;
+    }
+
+    /**
+     * @brief Get the position estimate
+     * @return Position (deg)
+     */
+    double getPosition() const {
+        return state(0);
+    }
+
+    /**
+     * @brief Get the velocity estimate
+     * @return Velocity (RPM)
+     */
+    double getVelocity() const {
+        return state(1);
+    }
+
+    /**
+     * @brief Get the acceleration estimate
+     * @return Acceleration (RPM/s)
+     */
+    double getAcceleration() const {
+        return state(2);
+    }
+
+    /**
+     * @brief Get the variance of the velocity estimate
+     * @return Variance (RPM^2)
+     */
+    double getVelocityVariance() const {
+        return covariance(1, 1);
+    }
+
+    /**
+     * @brief Get the variance of the acceleration estimate
+     * @return Variance ((RPM/s)^2)
+     */
+    double getAccelerationVariance() const {
+        return covariance(2, 2);
+    }
+
+    /**
+     * @brief Get the full state covariance
+     * @return Covariance ordered position, velocity, acceleration
+     */
+    const Eigen::Matrix3d& getCovariance() const {
+        return covariance;
+    }
+
+private:
+    /**
+     * @brief Apply one scalar measurement of a state component
+     * @param index State component measured
+     * @param measurement Measured value
+     * @param variance Measurement variance
+     */
+    void correct(int index, double measurement, double variance);
+
+    StateEstimatorOptions options;
+    Eigen::Vector3d state;
+    Eigen::Matrix3d covariance;
+    double command;
+    bool initialized;
+};
+
+} // namespace motor_characterization
+
+#endif // STATE_ESTIMATOR_HPP
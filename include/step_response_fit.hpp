@@ -0,0 +1,129 @@
+#ifndef STEP_RESPONSE_FIT_HPP
+#define STEP_RESPONSE_FIT_HPP
+
+#include <cstdint>
+#include <vector>
+#include "feedforward.hpp"
+#include "system_identification.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief Settings of a step response fit
+ */
+struct StepResponseOptions {
+    double minSteadySpeed;      // Segments settling slower than this (RPM) are not fitted
+    double minStepSize;         // Smaller velocity changes (RPM) give no time constant
+    double tailFraction;        // Share of a segment averaged for the initial final-velocity guess
+    int iterations;             // Gauss-Newton iterations per segment
+    std::uint32_t minSamples;   // Fewest samples in a fitted window
+
+    StepResponseOptions()
+        : minSteadySpeed(20.0), minStepSize(20.0), tailFraction(0.25), iterations(6), minSamples(20) {}
+};
+
+/**
+ * @brief First-order response fitted to one profile segment
+ *
+ * v(t) = finalVelocity + (initialVelocity - finalVelocity) * exp(-t / timeConstant),
+ * with t from the start of the fitted window.
+ */
+struct StepSegmentFit {
+    double voltage;             // Mean response voltage over the window (V)
+    double initialVelocity;     // Fitted velocity at the start of the window (RPM)
+    double finalVelocity;       // RPM
+    double timeConstant;        // s
+    double finalVelocityError;  // Standard errors (independent-residual approximation)
+    double timeConstantError;
+    double rmsResidual;         // RPM
+    std::uint32_t samples;
+    bool valid;                 // Final velocity usable
+    bool timeConstantValid;     // Step large enough to also fix the time constant
+};
+
+/**
+ * @brief Feedforward constants from per-segment step responses
+ *
+ * Between two voltage steps the model V = kS sign(v) + kV v + kA a is a
+ * first-order system: the velocity settles exponentially towards
+ * (V - kS sign(v)) / kV with time constant kA / kV. Fitting that curve to
+ * each segment gives the physical parameters directly, from the velocity
+ * alone and without differentiating it, so it is a cheap second opinion
+ * when the regression's acceleration is too noisy and its R^2 is poor.
+ *
+ * Each segment is seeded with a log-linear fit of the decay towards the
+ * mean of its tail, then refined by a few Gauss-Newton iterations on the
+ * three parameters; every iteration is one pass over the segment that
+ * accumulates a 3x3 system. Only the part of the segment after the last
+ * friction sign change, and after the velocity has started moving, is
+ * fitted, which also keeps the sensor delay out of the curve.
+ *
+ * kS and kV then come from regressing the segment voltages on their final
+ * velocities, and kA from the inverse-variance weighted time constant
+ * times kV.
+ */
+class StepResponseFit {
+public:
+    /**
+     * @brief Fit every segment of a capture
+     * @param sysId Identification object holding the samples (its voltage source is honoured)
+     * @param options Fit settings
+     */
+    explicit StepResponseFit(const SystemIdentification& sysId,
+                             const StepResponseOptions& options = StepResponseOptions());
+
+    /**
+     * @brief Get the per-segment fits in profile order
+     * @return One entry per segment
+     */
+    const std::vector<StepSegmentFit>& getSegments() const {
+        return segments;
+    }
+
+    /**
+     * @brief Check whether constants could be derived
+     * @return True if enough segments settled on both sides of zero and one gave a time constant
+     */
+    bool isValid() const {
+        return valid;
+    }
+
+    /**
+     * @brief Get the derived constants
+     * @return kS, kV, kA
+     */
+    const FeedforwardConstants& getConstants() const {
+        return constants;
+    }
+
+    /**
+     * @brief Get the standard errors of the derived constants
+     * @param term 0 for kS, 1 for kV, 2 for kA
+     * @return Standard error
+     */
+    double getError(int term) const {
+        return errors[term];
+    }
+
+    /**
+     * @brief Print the segment table and the constants next to a regression result
+     * @param regression Constants from the regression, for the cross-check
+     */
+    void printTable(const FeedforwardConstants& regression) const;
+
+private:
+    /**
+     * @brief Fit one segment's samples [begin, end)
+     */
+    StepSegmentFit fitSegment(const SystemIdentification& sysId, std::size_t begin, std::size_t end) const;
+
+    StepResponseOptions options;
+    std::vector<StepSegmentFit> segments;
+    FeedforwardConstants constants;
+    double errors[3];
+    bool valid;
+};
+
+} // namespace motor_characterization
+
+#endif // STEP_RESPONSE_FIT_HPP
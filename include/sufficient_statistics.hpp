@@ -0,0 +1,237 @@
+#ifndef SUFFICIENT_STATISTICS_HPP
+#define SUFFICIENT_STATISTICS_HPP
+
+#include <cstdint>
+#include <Eigen/Dense>
+#include "feedforward.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief Regression terms of the feedforward model, usable as a bitmask
+ */
+enum ModelTerm : std::uint32_t {
+    TERM_STATIC_FRICTION = 1u << 0,  // sign(v)
+    TERM_VELOCITY        = 1u << 1,  // v
+    TERM_ACCELERATION    = 1u << 2,  // a
+    TERM_ALL             = TERM_STATIC_FRICTION | TERM_VELOCITY | TERM_ACCELERATION
+};
+
+/**
+ * @brief Least squares solution of one sub-model
+ */
+struct StatisticsFit {
+    Eigen::Vector3d coefficients;  // kS, kV, kA; zero for terms not in the model
+    Eigen::Matrix3d covariance;    // s^2 (X^T X)^-1 assuming independent residuals
+    double residualSumSquares;
+    double rSquared;
+    bool valid;
+
+    StatisticsFit()
+        : coefficients(Eigen::Vector3d::Zero()), covariance(Eigen::Matrix3d::Zero()), residualSumSquares(0.0),
+          rSquared(0.0), valid(false) {}
+
+    /**
+     * @brief Get the coefficients as feedforward constants
+     * @return Constants
+     */
+    FeedforwardConstants getConstants() const {
+        return FeedforwardConstants(coefficients(0), coefficients(1), coefficients(2));
+    }
+};
+
+/**
+ * @brief Sufficient statistics of the feedforward regression
+ *
+ * Holds X^T X, X^T y, y^T y, sum(y), sum(x) and the sample count for the full
+ * regressor set [sign(v), v, a]. Any sub-model can be solved from these,
+ * and statistics of disjoint sample sets combine by addition, so fits over
+ * blocks, folds or segments never need to revisit the samples.
+ */
+class SufficientStatistics {
+public:
+    static constexpr int kTermCount = 3;
+
+    SufficientStatistics() {
+        clear();
+    }
+
+    /**
+     * @brief Build statistics from moments accumulated elsewhere
+     * @param gramMatrix X^T X (symmetric)
+     * @param cross X^T y
+     * @param regressors sum(x)
+     * @param sumSquares sum(y^2)
+     * @param sum sum(y)
+     * @param samples Sample count
+     */
+    SufficientStatistics(const Eigen::Matrix3d& gramMatrix, const Eigen::Vector3d& cross,
+                         const Eigen::Vector3d& regressors, double sumSquares, double sum, std::uint32_t samples)
+        : gram(gramMatrix), crossProduct(cross), regressorSum(regressors), responseSumSquares(sumSquares),
+          responseSum(sum), count(samples) {}
+
+    /**
+     * @brief Reset to an empty sample set
+     */
+    void clear() {
+        gram.setZero();
+        crossProduct.setZero();
+        regressorSum.setZero();
+        responseSumSquares = 0.0;
+        responseSum = 0.0;
+        count = 0;
+    }
+
+    /**
+     * @brief Add one sample
+     * @param velocity Velocity (RPM)
+     * @param acceleration Acceleration (RPM/s)
+     * @param voltage Response voltage (V)
+     */
+    void add(double velocity, double acceleration, double voltage) {
+        const Eigen::Vector3d x(frictionSign(velocity), velocity, acceleration);
+        gram.selfadjointView<Eigen::Upper>().rankUpdate(x);
+        crossProduct += x * voltage;
+        regressorSum += x;
+        responseSumSquares += voltage * voltage;
+        responseSum += voltage;
+        count++;
+    }
+
+    /**
+     * @brief Add the statistics of another, disjoint sample set
+     * @param other Statistics to merge
+     * @return This object
+     */
+    SufficientStatistics& operator+=(const SufficientStatistics& other) {
+        gram += other.gram;
+        crossProduct += other.crossProduct;
+        regressorSum += other.regressorSum;
+        responseSumSquares += other.responseSumSquares;
+        responseSum += other.responseSum;
+        count += other.count;
+        return *this;
+    }
+
+    /**
+     * @brief Remove the statistics of a subset previously added
+     * @param other Statistics to remove
+     * @return This object
+     */
+    SufficientStatistics& operator-=(const SufficientStatistics& other) {
+        gram -= other.gram;
+        crossProduct -= other.crossProduct;
+        regressorSum -= other.regressorSum;
+        responseSumSquares -= other.responseSumSquares;
+        responseSum -= other.responseSum;
+        count -= other.count;
+        return *this;
+    }
+
+    /**
+     * @brief Solve a sub-model by least squares
+     * @param terms Bitmask of ModelTerm values to include
+     * @return Fit; invalid if there are too few samples or the terms are not identifiable
+     */
+    StatisticsFit solve(std::uint32_t terms = TERM_ALL) const;
+
+    /**
+     * @brief Statistics of the same samples with one term's contribution removed from the response
+     *
+     * Equivalent to accumulating y - coefficient * x_term, so a term can be
+     * held at a known value (e.g. kA from a global fit) while the others are
+     * solved locally. Leave the fixed term out of the terms passed to solve().
+     *
+     * @param term Term to fix (a single ModelTerm bit)
+     * @param coefficient Value to hold it at
+     * @return Transformed statistics
+     */
+    SufficientStatistics withFixedTerm(ModelTerm term, double coefficient) const {
+        int j = 0;
+        while (j < kTermCount - 1 && !(term & (1u << j))) ++j;
+        const Eigen::Matrix3d full = gram.selfadjointView<Eigen::Upper>();
+        SufficientStatistics result = *this;
+        result.crossProduct -= coefficient * full.col(j);
+        result.responseSumSquares += -2.0 * coefficient * crossProduct(j) + coefficient * coefficient * full(j, j);
+        result.responseSum -= coefficient * regressorSum(j);
+        return result;
+    }
+
+    /**
+     * @brief Residual sum of squares of given coefficients on these samples
+     * @param coefficients kS, kV, kA
+     * @return Sum of squared prediction errors
+     */
+    double residualSumSquares(const Eigen::Vector3d& coefficients) const {
+        const Eigen::Matrix3d full = gram.selfadjointView<Eigen::Upper>();
+        return responseSumSquares - 2.0 * coefficients.dot(crossProduct) + coefficients.dot(full * coefficients);
+    }
+
+    /**
+     * @brief Total sum of squares of the response about its mean
+     * @return Sum of squares
+     */
+    double totalSumSquares() const {
+        return count > 0 ? responseSumSquares - responseSum * responseSum / count : 0.0;
+    }
+
+    /**
+     * @brief Get the number of samples
+     * @return Sample count
+     */
+    std::uint32_t getCount() const {
+        return count;
+    }
+
+    /**
+     * @brief Get X^T X (full symmetric matrix)
+     * @return Gram matrix ordered sign(v), v, a
+     */
+    Eigen::Matrix3d getGram() const {
+        return gram.selfadjointView<Eigen::Upper>();
+    }
+
+    /**
+     * @brief Get X^T y
+     * @return Cross-product vector ordered sign(v), v, a
+     */
+    const Eigen::Vector3d& getCrossProduct() const {
+        return crossProduct;
+    }
+
+    /**
+     * @brief Get the sum of each regressor
+     * @return Sums ordered sign(v), v, a
+     */
+    const Eigen::Vector3d& getRegressorSum() const {
+        return regressorSum;
+    }
+
+    /**
+     * @brief Get sum(y^2)
+     * @return Response sum of squares
+     */
+    double getResponseSumSquares() const {
+        return responseSumSquares;
+    }
+
+    /**
+     * @brief Get sum(y)
+     * @return Response sum
+     */
+    double getResponseSum() const {
+        return responseSum;
+    }
+
+private:
+    Eigen::Matrix3d gram;  // Upper triangle only
+    Eigen::Vector3d crossProduct;
+    Eigen::Vector3d regressorSum;
+    double responseSumSquares;
+    double responseSum;
+    std::uint32_t count;
+};
+
+} // namespace motor_characterization
+
+#endif // SUFFICIENT_STATISTICS_HPP
@@ -2,11 +2,17 @@
 #define SYSTEM_IDENTIFICATION_HPP
 
 #include <vector>
+#include <cstdint>
+#include <string>
 #include <cmath>
 #include <algorithm>
 #include <iostream>
 #include <Eigen/Dense>
 #include "api.h"
+#include "fault_detector.hpp"
+#include "feedforward.hpp"
+#include "sufficient_statistics.hpp"
+#include "telemetry_frame.hpp"
 
 namespace motor_characterization {
 
@@ -14,30 +20,105 @@ namespace motor_characterization {
  * @brief Data point structure for system identification
  */
 struct DataPoint {
-    double voltage;      // Input voltage (-127 to 127)
-    double velocity;     // Measured velocity (RPM)
-    double acceleration; // Measured acceleration (RPM/s)
-    double timestamp;    // Timestamp of measurement
+    double voltage;        // Commanded voltage (V)
+    double velocity;       // Measured velocity (RPM)
+    double acceleration;   // Measured acceleration (RPM/s)
+    double timestamp;      // Timestamp of measurement
+    double appliedVoltage; // Voltage the motor reports delivering (V)
+    double batteryVoltage; // Battery voltage at the time of measurement (V, 0 if unknown)
+    bool saturated;        // Commanded voltage could not be delivered
+    double velocityVariance;      // Variance of the velocity estimate (RPM^2, 0 if unknown)
+    double accelerationVariance;  // Variance of the acceleration estimate ((RPM/s)^2, 0 if unknown)
+    double current;               // Current draw (A, 0 if unknown)
+    std::uint32_t faults;         // MotorFault bits that exclude the sample from the fit
     
     DataPoint(double v, double vel, double acc, double t) 
-        : voltage(v), velocity(vel), acceleration(acc), timestamp(t) {}
+        : voltage(v), velocity(vel), acceleration(acc), timestamp(t),
+          appliedVoltage(v), batteryVoltage(0.0), saturated(false),
+          velocityVariance(0.0), accelerationVariance(0.0), current(0.0), faults(FAULT_NONE) {}
+    
+    DataPoint(double v, double vel, double acc, double t, double applied, double battery, bool sat)
+        : voltage(v), velocity(vel), acceleration(acc), timestamp(t),
+          appliedVoltage(applied), batteryVoltage(battery), saturated(sat),
+          velocityVariance(0.0), accelerationVariance(0.0), current(0.0), faults(FAULT_NONE) {}
+
+    /**
+     * @brief Unpack a telemetry frame (channels the frame lacks read as unknown)
+     * @param frame Frame to convert
+     */
+    explicit DataPoint(const TelemetryFrame& frame)
+        : voltage(frame.command / telemetry::kVoltageScale),
+          velocity(frame.velocity / telemetry::kVelocityScale),
+          acceleration(frame.acceleration / telemetry::kAccelerationScale),
+          timestamp(frame.time / telemetry::kTimeScale),
+          appliedVoltage((frame.channels & TELEMETRY_APPLIED_VOLTAGE) ? frame.applied / telemetry::kVoltageScale
+                                                                      : voltage),
+          batteryVoltage(frame.battery / telemetry::kVoltageScale),
+          saturated((frame.status & telemetry::kStatusSaturated) != 0),
+          velocityVariance(0.0), accelerationVariance(0.0),
+          current(frame.current / telemetry::kCurrentScale), faults(frame.faults) {}
 };
 
 /**
- * @brief Feedforward constants structure
+ * @brief Voltage used as the regression response
  */
-struct FeedforwardConstants {
-    double kS;  // Static friction constant
-    double kV;  // Velocity feedforward constant
-    double kA;  // Acceleration feedforward constant
-    
-    FeedforwardConstants(double s = 0.0, double v = 0.0, double a = 0.0) 
-        : kS(s), kV(v), kA(a) {}
+enum VoltageSource {
+    VOLTAGE_COMMANDED,  // Voltage passed to move_voltage (saturated samples are skipped)
+    VOLTAGE_MEASURED    // Voltage reported by the motor (all samples are used)
+};
+
+/**
+ * @brief Columns that can be selected for CSV export
+ */
+enum CsvColumn : std::uint32_t {
+    CSV_TIMESTAMP    = 1u << 0,
+    CSV_VOLTAGE      = 1u << 1,
+    CSV_VELOCITY     = 1u << 2,
+    CSV_ACCELERATION = 1u << 3,
+    CSV_APPLIED_VOLTAGE = 1u << 4,
+    CSV_BATTERY_VOLTAGE = 1u << 5,
+    CSV_SATURATED    = 1u << 6,
+    CSV_VELOCITY_VARIANCE     = 1u << 7,
+    CSV_ACCELERATION_VARIANCE = 1u << 8,
+    CSV_CURRENT      = 1u << 9,
+    CSV_FAULTS       = 1u << 10,
+    CSV_ALL_COLUMNS  = 0xFFFFFFFFu
+};
+
+/**
+ * @brief Options for CSV export
+ */
+struct CsvExportOptions {
+    std::uint32_t columns;  // Bitmask of CsvColumn values to write
+    int precision;          // Digits after the decimal point
     
-    // Calculate feedforward output
-    double calculate(double velocity, double acceleration) const {
-        return kS * (velocity > 0 ? 1.0 : -1.0) + kV * velocity + kA * acceleration;
-    }
+    CsvExportOptions(std::uint32_t cols = CSV_ALL_COLUMNS, int prec = 6)
+        : columns(cols), precision(prec) {}
+};
+
+/**
+ * @brief Uncertainty of the identified constants from a single run
+ *
+ * Parameters are ordered kS, kV, kA. Terms left out of the fit have zero
+ * variance. The covariance is s^2 (X^T X)^-1, optionally scaled by an AR(1)
+ * variance inflation factor because samples taken at 100 Hz have strongly
+ * correlated residuals and would otherwise give error bars that are far too
+ * narrow.
+ */
+struct ParameterUncertainty {
+    Eigen::Matrix3d covariance;
+    Eigen::Vector3d standardError;
+    Eigen::Vector3d confidenceHalfWidth;  // Interval is estimate +/- this
+    double confidenceLevel;               // e.g. 0.95
+    double residualStdDev;                // V
+    double residualAutocorrelation;       // Lag-1 correlation of residuals in sample order
+    double varianceInflation;             // Factor applied to the covariance (1 if uncorrected)
+    double effectiveSamples;              // Sample count after the correlation correction
+
+    ParameterUncertainty()
+        : covariance(Eigen::Matrix3d::Zero()), standardError(Eigen::Vector3d::Zero()),
+          confidenceHalfWidth(Eigen::Vector3d::Zero()), confidenceLevel(0.95), residualStdDev(0.0),
+          residualAutocorrelation(0.0), varianceInflation(1.0), effectiveSamples(0.0) {}
 };
 
 /**
@@ -55,9 +136,17 @@ private:
     FeedforwardConstants constants;
     double rSquared;
     bool isIdentified;
+    VoltageSource voltageSource;
+    ParameterUncertainty uncertainty;
+    double confidenceLevel;
+    bool correctAutocorrelation;
+    bool useVarianceWeights;
+    bool weighted;
 
 public:
-    SystemIdentification() : rSquared(0.0), isIdentified(false) {}
+    SystemIdentification()
+        : rSquared(0.0), isIdentified(false), voltageSource(VOLTAGE_COMMANDED),
+          confidenceLevel(0.95), correctAutocorrelation(true), useVarianceWeights(true), weighted(false) {}
 
     /**
      * @brief Add a data point to the identification dataset
@@ -80,6 +169,15 @@ public:
         isIdentified = false;
     }
 
+    /**
+     * @brief Add a data point from a telemetry frame
+     * @param frame Frame to add
+     */
+    void addDataPoint(const TelemetryFrame& frame) {
+        dataPoints.emplace_back(frame);
+        isIdentified = false;
+    }
+
     /**
      * @brief Clear all data points
      */
@@ -96,6 +194,47 @@ public:
         return dataPoints.size();
     }
 
+    /**
+     * @brief Select which voltage the regression is fitted against
+     * @param source Commanded or measured applied voltage
+     */
+    void setVoltageSource(VoltageSource source) {
+        voltageSource = source;
+        isIdentified = false;
+    }
+
+    /**
+     * @brief Get the voltage the regression is fitted against
+     * @return Voltage source
+     */
+    VoltageSource getVoltageSource() const {
+        return voltageSource;
+    }
+
+    /**
+     * @brief Check whether a data point takes part in the regression
+     * @param point Data point to check
+     * @return False for faulted points, and for saturated points when fitting against the commanded voltage
+     */
+    bool isUsable(const DataPoint& point) const {
+        return point.faults == FAULT_NONE && (voltageSource == VOLTAGE_MEASURED || !point.saturated);
+    }
+
+    /**
+     * @brief Get the regression response for a data point
+     * @param point Data point
+     * @return Commanded or applied voltage, depending on the voltage source
+     */
+    double responseVoltage(const DataPoint& point) const {
+        return voltageSource == VOLTAGE_MEASURED ? point.appliedVoltage : point.voltage;
+    }
+
+    /**
+     * @brief Get the number of data points used by the regression
+     * @return Number of usable data points
+     */
+    size_t getUsableDataPointCount() const;
+
     /**
      * @brief Perform system identification using least squares regression
      * @param includeStaticFriction Whether to include static friction term
@@ -120,6 +259,48 @@ public:
         return rSquared;
     }
 
+    /**
+     * @brief Configure the uncertainty computed by identify()
+     * @param level Confidence level of the intervals (e.g. 0.95)
+     * @param correctForAutocorrelation Inflate the covariance for correlated residuals
+     */
+    void setUncertaintyOptions(double level, bool correctForAutocorrelation) {
+        confidenceLevel = level;
+        correctAutocorrelation = correctForAutocorrelation;
+        isIdentified = false;
+    }
+
+    /**
+     * @brief Weight samples by the variance of their velocity and acceleration estimates
+     *
+     * Only has an effect when the samples carry variances (e.g. from
+     * MotorStateEstimator). Each sample is weighted by the inverse of its
+     * equation error variance, s0^2 + kV^2 var(v) + kA^2 var(a), with kV and kA
+     * from an unweighted first pass.
+     *
+     * @param enable Use weighted least squares when variances are available
+     */
+    void setVarianceWeighting(bool enable) {
+        useVarianceWeights = enable;
+        isIdentified = false;
+    }
+
+    /**
+     * @brief Check whether the last identify() used variance weights
+     * @return True if the fit was weighted
+     */
+    bool isWeighted() const {
+        return weighted;
+    }
+
+    /**
+     * @brief Get the covariance, standard errors and confidence intervals of the constants
+     * @return Uncertainty from the last successful identify()
+     */
+    const ParameterUncertainty& getUncertainty() const {
+        return uncertainty;
+    }
+
     /**
      * @brief Check if system has been identified
      * @return True if identification has been performed
@@ -162,6 +343,14 @@ public:
      */
     bool exportToCSV(const std::string& filename) const;
 
+    /**
+     * @brief Export selected columns to CSV with a given precision
+     * @param filename Output filename
+     * @param options Column selection and precision
+     * @return True if export was successful
+     */
+    bool exportToCSV(const std::string& filename, const CsvExportOptions& options) const;
+
     /**
      * @brief Get data points for external analysis
      * @return Vector of data points
@@ -170,6 +359,12 @@ public:
         return dataPoints;
     }
 
+    /**
+     * @brief Accumulate the usable samples into sufficient statistics
+     * @return Statistics of the full regressor set, from which any sub-model can be solved
+     */
+    SufficientStatistics getSufficientStatistics() const;
+
     /**
      * @brief Get the design matrix for external analysis
      * @param includeStaticFriction Whether to include static friction term
@@ -199,6 +394,14 @@ private:
      */
     Eigen::VectorXd buildResponseVector() const;
 
+    /**
+     * @brief Build inverse-variance weights for the usable samples
+     * @param residualVariance Residual variance of the unweighted fit
+     * @param weights Receives one weight per usable sample
+     * @return False if no sample carries a variance
+     */
+    bool buildVarianceWeights(double residualVariance, Eigen::VectorXd& weights) const;
+
     /**
      * @brief Calculate R-squared value
      * @param predicted Predicted values
@@ -206,6 +409,16 @@ private:
      * @return R-squared value
      */
     double calculateRSquared(const Eigen::VectorXd& predicted, const Eigen::VectorXd& actual) const;
+
+    /**
+     * @brief Compute the parameter uncertainty of a fit
+     * @param X Design matrix (unweighted)
+     * @param residuals Unweighted residuals in sample order
+     * @param columns Parameter index (kS, kV, kA) of each design matrix column
+     * @param weights Per-sample weights of a weighted fit, empty if unweighted
+     */
+    void calculateUncertainty(const Eigen::MatrixXd& X, const Eigen::VectorXd& residuals,
+                              const std::vector<int>& columns, const Eigen::VectorXd& weights);
 };
 
 } // namespace motor_characterization
@@ -0,0 +1,98 @@
+#ifndef TELEMETRY_FRAME_HPP
+#define TELEMETRY_FRAME_HPP
+
+#include <cmath>
+#include <cstdint>
+
+namespace motor_characterization {
+
+/**
+ * @brief Motor readings that can be enabled per tick, usable as a bitmask
+ */
+enum TelemetryChannel : std::uint32_t {
+    TELEMETRY_VELOCITY        = 1u << 0,  // get_actual_velocity
+    TELEMETRY_APPLIED_VOLTAGE = 1u << 1,  // get_voltage
+    TELEMETRY_BATTERY_VOLTAGE = 1u << 2,  // pros::battery::get_voltage
+    TELEMETRY_CURRENT         = 1u << 3,  // get_current_draw
+    TELEMETRY_FAULTS          = 1u << 4,  // get_faults and get_flags
+    TELEMETRY_POSITION        = 1u << 5,  // get_position
+    TELEMETRY_TORQUE          = 1u << 6,  // get_torque
+    TELEMETRY_POWER           = 1u << 7,  // get_power
+    TELEMETRY_EFFICIENCY      = 1u << 8,  // get_efficiency
+    TELEMETRY_TEMPERATURE     = 1u << 9,  // get_temperature
+    TELEMETRY_ALL_CHANNELS    = (1u << 10) - 1
+};
+
+/**
+ * @brief Number of TelemetryChannel bits
+ */
+constexpr int kTelemetryChannelCount = 10;
+
+/**
+ * @brief Fixed-point scales of the frame fields
+ */
+namespace telemetry {
+    constexpr double kTimeScale = 1000.0;          // s -> ms
+    constexpr double kVoltageScale = 1000.0;       // V -> mV
+    constexpr double kVelocityScale = 100.0;       // RPM -> 0.01 RPM
+    constexpr double kAccelerationScale = 10.0;    // RPM/s -> 0.1 RPM/s
+    constexpr double kPositionScale = 100.0;       // deg -> 0.01 deg
+    constexpr double kCurrentScale = 1000.0;       // A -> mA
+    constexpr double kTorqueScale = 1000.0;        // Nm -> mNm
+    constexpr double kPowerScale = 100.0;          // W -> 10 mW
+
+    constexpr std::uint8_t kStatusSaturated = 1u << 0;
+
+    /**
+     * @brief Round a reading to a frame field, saturating at the field's range
+     * @param value Reading
+     * @param scale Field scale
+     * @param low Smallest field value
+     * @param high Largest field value
+     * @return Field value
+     */
+    inline std::int32_t toField(double value, double scale, std::int32_t low, std::int32_t high) {
+        double scaled = std::round(value * scale);
+        if (!(scaled > low)) return low;  // Also catches NaN
+        if (scaled > high) return high;
+        return static_cast<std::int32_t>(scaled);
+    }
+} // namespace telemetry
+
+/**
+ * @brief Every reading of one tick, packed into 36 bytes
+ *
+ * All fields are fixed-point integers, so a frame can be copied, logged
+ * and compared without touching floating point. The channels mask says
+ * which readings were taken and succeeded; the rest are zero. Velocity
+ * and acceleration are the values used for identification (filtered when
+ * the sampler has a state estimator).
+ */
+struct TelemetryFrame {
+    std::int32_t time;           // ms since the start of the step
+    std::int32_t velocity;       // 0.01 RPM
+    std::int32_t acceleration;   // 0.1 RPM/s
+    std::int32_t position;       // 0.01 deg
+    std::int16_t command;        // Commanded voltage (mV)
+    std::int16_t applied;        // Applied voltage (mV)
+    std::uint16_t battery;       // Battery voltage (mV)
+    std::int16_t current;        // mA
+    std::int16_t torque;         // mNm
+    std::int16_t power;          // 10 mW
+    std::uint16_t channels;      // TelemetryChannel bits present in this frame
+    std::uint16_t faults;        // MotorFault bits that exclude the sample from the fit
+    std::uint8_t efficiency;     // %
+    std::int8_t temperature;     // C
+    std::uint8_t hardware;       // Motor fault word (low nibble) and flags (high nibble)
+    std::uint8_t status;         // telemetry::kStatus* bits
+
+    TelemetryFrame()
+        : time(0), velocity(0), acceleration(0), position(0), command(0), applied(0), battery(0), current(0),
+          torque(0), power(0), channels(0), faults(0), efficiency(0), temperature(0), hardware(0), status(0) {}
+};
+
+static_assert(sizeof(TelemetryFrame) == 36, "TelemetryFrame must stay packed");
+
+} // namespace motor_characterization
+
+#endif // TELEMETRY_FRAME_HPP
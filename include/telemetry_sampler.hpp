@@ -0,0 +1,106 @@
+#ifndef TELEMETRY_SAMPLER_HPP
+#define TELEMETRY_SAMPLER_HPP
+
+#include <cstdint>
+#include "api.h"
+#include "telemetry_frame.hpp"
+
+namespace motor_characterization {
+
+/**
+ * @brief Time spent reading telemetry
+ */
+struct TelemetryCost {
+    std::uint32_t ticks;                                 // Frames read
+    double meanTickMicros;                               // Mean time per frame (us)
+    std::uint32_t maxTickMicros;                         // Slowest frame (us)
+    double channelMicros[kTelemetryChannelCount];        // Mean time per read of each channel (us, 0 if never read)
+    double meanChannelMicros;                            // Mean time per read over all channels (us)
+
+    TelemetryCost() : ticks(0), meanTickMicros(0.0), maxTickMicros(0), channelMicros(), meanChannelMicros(0.0) {}
+
+    /**
+     * @brief Estimate how many channel reads fit in a time budget
+     * @param budgetMicros Budget per tick (us), e.g. 10000 at 100 Hz
+     * @return Channel reads at the measured mean cost, 0 if nothing was measured
+     */
+    int channelsWithin(double budgetMicros) const {
+        return meanChannelMicros > 0.0 ? static_cast<int>(budgetMicros / meanChannelMicros) : 0;
+    }
+};
+
+/**
+ * @brief Reads the enabled telemetry channels of a motor into frames
+ *
+ * Every PROS getter is a round trip to the motor's cached state, so each
+ * enabled channel adds to the time a tick spends reading. Only the
+ * channels in the mask are read, and each read is timed so the cost of a
+ * channel set can be measured on the robot instead of guessed.
+ */
+class TelemetrySampler {
+public:
+    /**
+     * @brief Create a sampler for a motor
+     * @param motor Motor to read (must outlive the sampler)
+     * @param channels Bitmask of TelemetryChannel values to read
+     */
+    TelemetrySampler(pros::Motor& motor, std::uint32_t channels);
+
+    /**
+     * @brief Select the channels read from now on
+     * @param mask Bitmask of TelemetryChannel values
+     */
+    void setChannels(std::uint32_t mask) {
+        channels = mask & TELEMETRY_ALL_CHANNELS;
+    }
+
+    /**
+     * @brief Get the channels being read
+     * @return Bitmask of TelemetryChannel values
+     */
+    std::uint32_t getChannels() const {
+        return channels;
+    }
+
+    /**
+     * @brief Read the enabled channels
+     *
+     * Fills the measured fields of the frame and sets its channels mask to
+     * the channels that were read successfully; fields of the other
+     * channels are zeroed. Time, command, acceleration, faults and status
+     * are left for the caller.
+     *
+     * @param frame Receives the readings
+     */
+    void read(TelemetryFrame& frame);
+
+    /**
+     * @brief Get the measured read cost
+     * @return Cost since construction or the last resetCost()
+     */
+    TelemetryCost getCost() const;
+
+    /**
+     * @brief Forget the measured read cost
+     */
+    void resetCost();
+
+private:
+    /**
+     * @brief Read one channel into the frame
+     * @return True if the motor answered
+     */
+    bool readChannel(int channel, TelemetryFrame& frame);
+
+    pros::Motor& motor;
+    std::uint32_t channels;
+    std::uint32_t ticks;
+    std::uint64_t tickMicros;
+    std::uint32_t maxTickMicros;
+    std::uint64_t channelMicros[kTelemetryChannelCount];
+    std::uint32_t channelReads[kTelemetryChannelCount];
+};
+
+} // namespace motor_characterization
+
+#endif // TELEMETRY_SAMPLER_HPP
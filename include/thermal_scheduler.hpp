@@ -0,0 +1,130 @@
+#ifndef THERMAL_SCHEDULER_HPP
+#define THERMAL_SCHEDULER_HPP
+
+#include <Eigen/Dense>
+
+namespace motor_characterization {
+
+/**
+ * @brief First-order thermal model of a motor
+ *
+ * dT/dt = (ambient - T) / timeConstant + heating * I^2
+ */
+struct ThermalModel {
+    double ambient;       // Temperature the motor cools towards (C)
+    double timeConstant;  // Cooling time constant (s)
+    double heating;       // Temperature rise rate per A^2 of current (C/s/A^2)
+    bool valid;
+
+    ThermalModel() : ambient(0.0), timeConstant(0.0), heating(0.0), valid(false) {}
+
+    /**
+     * @brief Predict the temperature after cooling with no current
+     * @param temperature Temperature now (C)
+     * @param seconds Time from now (s)
+     * @return Predicted temperature (C)
+     */
+    double predictCooling(double temperature, double seconds) const;
+
+    /**
+     * @brief Time for the motor to cool to a temperature
+     * @param temperature Temperature now (C)
+     * @param target Temperature to reach (C)
+     * @return Seconds; 0 if already there, infinite if the model never gets there
+     */
+    double timeToCool(double temperature, double target) const;
+};
+
+/**
+ * @brief Decides when the next of a series of runs may start
+ *
+ * kV drifts with winding temperature, so runs are only comparable if they
+ * start at about the same temperature. The first run's start temperature
+ * is the reference; each later run starts as soon as the temperature is
+ * predicted to be within tolerance above it, and at once if it already is.
+ *
+ * The V5 reports temperature in 5 C steps, so waiting on the reading alone
+ * would overshoot by up to a step. Instead a ThermalModel is fitted online
+ * by least squares on dT/dt = a + b T + c I^2 over every observed interval
+ * (rests polled by the scheduler, runs summarized by their mean I^2), and
+ * the cooling prediction from the last run's end decides the start.
+ */
+class ThermalScheduler {
+public:
+    /**
+     * @brief Create a scheduler
+     * @param tolerance Allowed start temperature above the first run's (C)
+     * @param maxWait Longest wait before starting anyway (s)
+     */
+    explicit ThermalScheduler(double tolerance = 2.5, double maxWait = 300.0);
+
+    /**
+     * @brief Record a finished run
+     * @param startTime Run start (s)
+     * @param startTemperature Temperature at the start (C)
+     * @param endTime Run end (s)
+     * @param endTemperature Temperature at the end (C)
+     * @param meanCurrentSquared Mean of I^2 over the run (A^2)
+     */
+    void recordRun(double startTime, double startTemperature, double endTime, double endTemperature,
+                   double meanCurrentSquared);
+
+    /**
+     * @brief Feed a temperature reading taken while the motor rests
+     * @param time Time of the reading (s)
+     * @param temperature Reading (C)
+     */
+    void observeRest(double time, double temperature);
+
+    /**
+     * @brief Decide whether the next run may start
+     * @param time Now (s)
+     * @param temperature Current reading (C)
+     * @return True if the predicted temperature is in the band or the wait limit is reached
+     */
+    bool readyToStart(double time, double temperature) const;
+
+    /**
+     * @brief Predicted temperature now
+     * @param time Now (s)
+     * @param temperature Current reading (C)
+     * @return Model prediction from the last run's end, kept within half a reading step of the reading
+     */
+    double predictTemperature(double time, double temperature) const;
+
+    /**
+     * @brief Get the upper edge of the start band
+     * @return Temperature (C); infinite before the first run
+     */
+    double getStartLimit() const;
+
+    /**
+     * @brief Get the fitted thermal model
+     * @return Model; invalid until enough varied intervals are observed
+     */
+    const ThermalModel& getModel() const {
+        return model;
+    }
+
+private:
+    /**
+     * @brief Add one interval to the regression and refit
+     */
+    void addInterval(double duration, double startTemperature, double endTemperature, double meanCurrentSquared);
+
+    double tolerance;
+    double maxWait;
+    bool haveReference;
+    double referenceTemperature;
+    double lastRunEnd;           // Time the last run finished (s), negative before any
+    double lastRunTemperature;   // Reading when it finished (C)
+    double restTime;             // Previous rest reading
+    double restTemperature;
+    Eigen::Matrix3d gram;        // Sum of dt x x^T, x = [1, T, I^2]
+    Eigen::Vector3d cross;       // Sum of dt x dT/dt
+    ThermalModel model;
+};
+
+} // namespace motor_characterization
+
+#endif // THERMAL_SCHEDULER_HPP
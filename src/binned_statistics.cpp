@@ -0,0 +1,223 @@
+#include "binned_statistics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdio>
+#include "crc32.hpp"
+
+namespace motor_characterization {
+
+namespace {
+
+constexpr std::uint32_t kArchiveMagic = 0x4E42434D;  // "MCBN"
+constexpr std::uint16_t kArchiveVersion = 1;
+
+// Entries of BinCell::moments by pair of (velocity, acceleration, voltage)
+constexpr int kMomentRow[6] = {0, 0, 0, 1, 1, 2};
+constexpr int kMomentColumn[6] = {0, 1, 2, 1, 2, 2};
+
+/**
+ * @brief Archive file header, followed by cellCount ArchiveCell records
+ */
+struct ArchiveHeader {
+    std::uint32_t magic;
+    std::uint16_t version;
+    std::uint8_t voltageBins;
+    std::uint8_t velocityBins;
+    std::uint8_t accelerationBins;
+    std::uint8_t voltageSource;
+    std::uint16_t reserved;
+    float maxVelocity;
+    float accelerationThreshold;
+    std::uint32_t cellCount;
+    std::uint32_t sampleCount;
+    std::uint32_t crc;            // CRC-32 of the preceding fields and all cell records
+};
+
+/**
+ * @brief One occupied cell in an archive (single precision halves the file)
+ */
+struct ArchiveCell {
+    std::uint16_t index;
+    std::uint16_t reserved;
+    std::uint32_t count;
+    float mean[3];
+    float moments[6];
+};
+
+static_assert(sizeof(ArchiveHeader) == 32, "ArchiveHeader is an on-disk format");
+static_assert(sizeof(ArchiveCell) == 44, "ArchiveCell is an on-disk format");
+
+} // namespace
+
+BinnedStatistics::BinnedStatistics(const BinningOptions& options, VoltageSource source)
+    : options(options), voltageSource(source), cells(kCellCount), sampleCount(0), occupiedCells(0) {}
+
+void BinnedStatistics::clear() {
+    std::fill(cells.begin(), cells.end(), BinCell());
+    sampleCount = 0;
+    occupiedCells = 0;
+}
+
+bool BinnedStatistics::add(double velocity, double acceleration, double voltage) {
+    if (!std::isfinite(velocity) || !std::isfinite(acceleration) || !std::isfinite(voltage)) {
+        return false;
+    }
+
+    // Out-of-range samples land in the edge bins; the moments stay exact either way
+    int voltageBin = std::clamp(static_cast<int>(std::floor(voltage + kMaxVoltage)), 0, kVoltageBins - 1);
+    int velocityBin = kVelocityHalfBins;
+    if (velocity != 0.0) {
+        double width = options.maxVelocity / kVelocityHalfBins;
+        int offset = std::min(static_cast<int>(std::fabs(velocity) / width), kVelocityHalfBins - 1) + 1;
+        velocityBin += velocity > 0.0 ? offset : -offset;
+    }
+    int accelerationBin = acceleration < -options.accelerationThreshold ? 0
+                        : acceleration > options.accelerationThreshold ? 2 : 1;
+
+    BinCell& cell = cells[cellIndex(voltageBin, velocityBin, accelerationBin)];
+    if (cell.count == 0) occupiedCells++;
+    cell.count++;
+    sampleCount++;
+
+    // Welford update of the means and centered co-moments
+    const double x[3] = {velocity, acceleration, voltage};
+    double before[3];
+    double after[3];
+    for (int i = 0; i < 3; ++i) {
+        before[i] = x[i] - cell.mean[i];
+        cell.mean[i] += before[i] / cell.count;
+        after[i] = x[i] - cell.mean[i];
+    }
+    for (int k = 0; k < 6; ++k) {
+        cell.moments[k] += before[kMomentRow[k]] * after[kMomentColumn[k]];
+    }
+    return true;
+}
+
+bool BinnedStatistics::add(const DataPoint& point) {
+    if (point.faults != FAULT_NONE) return false;
+    if (voltageSource == VOLTAGE_COMMANDED && point.saturated) return false;
+    double voltage = voltageSource == VOLTAGE_MEASURED ? point.appliedVoltage : point.voltage;
+    return add(point.velocity, point.acceleration, voltage);
+}
+
+SufficientStatistics BinnedStatistics::toStatistics(std::uint32_t maxCellCount) const {
+    Eigen::Matrix3d gram = Eigen::Matrix3d::Zero();
+    Eigen::Vector3d cross = Eigen::Vector3d::Zero();
+    Eigen::Vector3d regressors = Eigen::Vector3d::Zero();
+    double responseSumSquares = 0.0;
+    double responseSum = 0.0;
+    double weightedCount = 0.0;
+
+    for (int index = 0; index < kCellCount; ++index) {
+        const BinCell& cell = cells[index];
+        if (cell.count == 0) continue;
+
+        const double n = cell.count;
+        const double weight = maxCellCount > 0 && cell.count > maxCellCount ? maxCellCount / n : 1.0;
+        const double sign = cellSign(index);
+        const double* mean = cell.mean;
+
+        // Raw sums of products rebuilt from the centered moments
+        double products[6];
+        for (int k = 0; k < 6; ++k) {
+            products[k] = weight * (cell.moments[k] + n * mean[kMomentRow[k]] * mean[kMomentColumn[k]]);
+        }
+        const double sumV = weight * n * mean[0];
+        const double sumA = weight * n * mean[1];
+        const double sumY = weight * n * mean[2];
+
+        // Upper triangle over [sign(v), v, a]
+        gram(0, 0) += weight * n * sign * sign;
+        gram(0, 1) += sign * sumV;
+        gram(0, 2) += sign * sumA;
+        gram(1, 1) += products[0];
+        gram(1, 2) += products[1];
+        gram(2, 2) += products[3];
+        cross(0) += sign * sumY;
+        cross(1) += products[2];
+        cross(2) += products[4];
+        regressors(0) += weight * n * sign;
+        regressors(1) += sumV;
+        regressors(2) += sumA;
+        responseSumSquares += products[5];
+        responseSum += sumY;
+        weightedCount += weight * n;
+    }
+
+    return SufficientStatistics(gram, cross, regressors, responseSumSquares, responseSum,
+                                static_cast<std::uint32_t>(std::lround(weightedCount)));
+}
+
+bool BinnedStatistics::save(const std::string& filename) const {
+    std::FILE* file = std::fopen(filename.c_str(), "wb");
+    if (file == nullptr) return false;
+
+    ArchiveHeader header{};
+    header.magic = kArchiveMagic;
+    header.version = kArchiveVersion;
+    header.voltageBins = kVoltageBins;
+    header.velocityBins = kVelocityBins;
+    header.accelerationBins = kAccelerationBins;
+    header.voltageSource = static_cast<std::uint8_t>(voltageSource);
+    header.maxVelocity = static_cast<float>(options.maxVelocity);
+    header.accelerationThreshold = static_cast<float>(options.accelerationThreshold);
+    header.cellCount = static_cast<std::uint32_t>(occupiedCells);
+    header.sampleCount = sampleCount;
+
+    // The checksum covers the cells too, so the header is finished once they are written
+    bool ok = std::fwrite(&header, sizeof(header), 1, file) == 1;
+    std::uint32_t crc = crc32(&header, offsetof(ArchiveHeader, crc));
+    for (int index = 0; index < kCellCount && ok; ++index) {
+        const BinCell& cell = cells[index];
+        if (cell.count == 0) continue;
+        ArchiveCell record{};
+        record.index = static_cast<std::uint16_t>(index);
+        record.count = cell.count;
+        for (int i = 0; i < 3; ++i) record.mean[i] = static_cast<float>(cell.mean[i]);
+        for (int k = 0; k < 6; ++k) record.moments[k] = static_cast<float>(cell.moments[k]);
+        crc = crc32(&record, sizeof(record), crc);
+        ok = std::fwrite(&record, sizeof(record), 1, file) == 1;
+    }
+    header.crc = crc;
+    ok = ok && std::fseek(file, 0, SEEK_SET) == 0 && std::fwrite(&header, sizeof(header), 1, file) == 1;
+    return std::fclose(file) == 0 && ok;
+}
+
+bool BinnedStatistics::load(const std::string& filename) {
+    clear();
+    std::FILE* file = std::fopen(filename.c_str(), "rb");
+    if (file == nullptr) return false;
+
+    ArchiveHeader header;
+    bool ok = std::fread(&header, sizeof(header), 1, file) == 1 && header.magic == kArchiveMagic &&
+              header.version == kArchiveVersion && header.voltageBins == kVoltageBins &&
+              header.velocityBins == kVelocityBins && header.accelerationBins == kAccelerationBins &&
+              header.cellCount <= static_cast<std::uint32_t>(kCellCount);
+    std::uint32_t crc = crc32(&header, offsetof(ArchiveHeader, crc));
+    for (std::uint32_t i = 0; ok && i < header.cellCount; ++i) {
+        ArchiveCell record;
+        ok = std::fread(&record, sizeof(record), 1, file) == 1 && record.index < kCellCount && record.count > 0 &&
+             cells[record.index].count == 0;
+        if (!ok) break;
+        crc = crc32(&record, sizeof(record), crc);
+        BinCell& cell = cells[record.index];
+        cell.count = record.count;
+        for (int j = 0; j < 3; ++j) cell.mean[j] = record.mean[j];
+        for (int k = 0; k < 6; ++k) cell.moments[k] = record.moments[k];
+        sampleCount += record.count;
+        occupiedCells++;
+    }
+    std::fclose(file);
+
+    if (!ok || crc != header.crc || sampleCount != header.sampleCount) {
+        clear();
+        return false;
+    }
+    options = BinningOptions(header.maxVelocity, header.accelerationThreshold);
+    voltageSource = static_cast<VoltageSource>(header.voltageSource);
+    return true;
+}
+
+} // namespace motor_characterization
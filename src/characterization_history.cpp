@@ -0,0 +1,259 @@
+#include "characterization_history.hpp"
+#include "crc32.hpp"
+#include <cstddef>
+#include <cstring>
+#include <ctime>
+
+namespace motor_characterization {
+
+namespace {
+
+constexpr std::uint32_t kRecordMagic = 0x5248434D;  // "MCHR"
+constexpr std::uint32_t kIndexMagic = 0x5849434D;   // "MCIX"
+constexpr std::uint32_t kIndexVersion = 1;
+constexpr std::uint32_t kMaxIndexEntries = 1024;
+
+/**
+ * @brief Header of the index file, followed by entryCount index entries
+ */
+struct IndexHeader {
+    std::uint32_t magic;
+    std::uint32_t version;
+    std::uint32_t entryCount;
+    std::uint32_t coveredBytes;   // Data file length represented by the index
+    std::uint32_t nextSequence;
+    std::uint32_t crc;            // CRC-32 of the preceding fields and all entries
+};
+
+bool isValidRecord(const HistoryRecord& record) {
+    return record.magic == kRecordMagic &&
+           record.crc == crc32(&record, offsetof(HistoryRecord, crc));
+}
+
+/**
+ * @brief Visit every valid record in the data file from an offset
+ *
+ * A torn append leaves a partial record; the scan then slides forward one
+ * byte at a time until the magic and checksum line up again, so records
+ * appended after the damage are still found.
+ *
+ * @return File length, or -1 if the file does not exist
+ */
+template <typename Visitor>
+long scanRecords(const std::string& path, long offset, Visitor&& visit) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) return -1;
+
+    HistoryRecord record;
+    long position = offset;
+    std::fseek(file, position, SEEK_SET);
+    while (std::fread(&record, sizeof(record), 1, file) == 1) {
+        if (isValidRecord(record)) {
+            visit(record);
+            position += sizeof(record);
+        } else {
+            position += 1;
+            std::fseek(file, position, SEEK_SET);
+        }
+    }
+
+    std::fseek(file, 0, SEEK_END);
+    long length = std::ftell(file);
+    std::fclose(file);
+    return length;
+}
+
+long fileLength(const std::string& path) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) return 0;
+    std::fseek(file, 0, SEEK_END);
+    long length = std::ftell(file);
+    std::fclose(file);
+    return length;
+}
+
+} // namespace
+
+MotorKey::MotorKey(std::uint8_t p, const char* name) : port(p) {
+    std::memset(label, 0, sizeof(label));
+    std::strncpy(label, name, sizeof(label) - 1);
+}
+
+bool MotorKey::operator==(const MotorKey& other) const {
+    return port == other.port && std::strncmp(label, other.label, sizeof(label)) == 0;
+}
+
+CharacterizationHistory::CharacterizationHistory(const std::string& directory)
+    : dataPath(directory + "/mchist.dat"), indexPath(directory + "/mchist.idx"),
+      nextSequence(0), coveredBytes(0), loaded(false) {}
+
+bool CharacterizationHistory::load() {
+    entries.clear();
+    nextSequence = 0;
+    coveredBytes = 0;
+
+    // Fast path: the index holds everything up to coveredBytes
+    bool indexValid = false;
+    if (std::FILE* file = std::fopen(indexPath.c_str(), "rb")) {
+        IndexHeader header;
+        if (std::fread(&header, sizeof(header), 1, file) == 1 &&
+            header.magic == kIndexMagic && header.version == kIndexVersion &&
+            header.entryCount <= kMaxIndexEntries) {
+            entries.resize(header.entryCount);
+            bool complete = header.entryCount == 0 ||
+                std::fread(entries.data(), sizeof(HistoryIndexEntry), header.entryCount, file) == header.entryCount;
+            std::uint32_t crc = crc32(&header, offsetof(IndexHeader, crc));
+            crc = crc32(entries.data(), entries.size() * sizeof(HistoryIndexEntry), crc);
+            if (complete && crc == header.crc) {
+                indexValid = true;
+                nextSequence = header.nextSequence;
+                coveredBytes = header.coveredBytes;
+            }
+        }
+        std::fclose(file);
+    }
+
+    if (!indexValid) {
+        entries.clear();
+    }
+
+    // Catch up on records appended after the index was written. If the data
+    // file is shorter than the index claims, it was replaced: rebuild.
+    long dataLength = fileLength(dataPath);
+    if (dataLength < coveredBytes) {
+        entries.clear();
+        nextSequence = 0;
+        coveredBytes = 0;
+        indexValid = false;
+    }
+
+    if (dataLength > coveredBytes) {
+        coveredBytes = scanFrom(coveredBytes);
+        indexValid = false;
+    }
+
+    loaded = true;
+    if (!indexValid) {
+        saveIndex();
+    }
+    return true;
+}
+
+long CharacterizationHistory::scanFrom(long offset) {
+    long length = scanRecords(dataPath, offset, [this](const HistoryRecord& record) {
+        applyRecord(record);
+    });
+    return length < 0 ? 0 : length;
+}
+
+void CharacterizationHistory::applyRecord(const HistoryRecord& record) {
+    HistoryIndexEntry* entry = nullptr;
+    for (auto& candidate : entries) {
+        if (candidate.key == record.key) {
+            entry = &candidate;
+            break;
+        }
+    }
+    if (entry == nullptr) {
+        entries.emplace_back();
+        entry = &entries.back();
+        std::memset(static_cast<void*>(entry), 0, sizeof(HistoryIndexEntry));
+        entry->key = record.key;
+    }
+
+    entry->recordCount++;
+    entry->latest = record;
+
+    // Keep the newest kTrendLength results, oldest first
+    if (entry->trendCount == HistoryIndexEntry::kTrendLength) {
+        std::memmove(&entry->trend[0], &entry->trend[1],
+                     sizeof(HistoryTrendPoint) * (HistoryIndexEntry::kTrendLength - 1));
+        entry->trendCount--;
+    }
+    HistoryTrendPoint& point = entry->trend[entry->trendCount++];
+    point.unixTime = record.unixTime;
+    point.sequence = record.sequence;
+    point.kS = static_cast<float>(record.kS);
+    point.kV = static_cast<float>(record.kV);
+    point.kA = static_cast<float>(record.kA);
+    point.rSquared = record.rSquared;
+    point.reserved = 0;
+
+    if (record.sequence >= nextSequence) {
+        nextSequence = record.sequence + 1;
+    }
+}
+
+bool CharacterizationHistory::saveIndex() const {
+    std::FILE* file = std::fopen(indexPath.c_str(), "wb");
+    if (file == nullptr) return false;
+
+    IndexHeader header;
+    header.magic = kIndexMagic;
+    header.version = kIndexVersion;
+    header.entryCount = static_cast<std::uint32_t>(entries.size());
+    header.coveredBytes = static_cast<std::uint32_t>(coveredBytes);
+    header.nextSequence = nextSequence;
+    header.crc = crc32(&header, offsetof(IndexHeader, crc));
+    header.crc = crc32(entries.data(), entries.size() * sizeof(HistoryIndexEntry), header.crc);
+
+    bool success = std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+        (entries.empty() ||
+         std::fwrite(entries.data(), sizeof(HistoryIndexEntry), entries.size(), file) == entries.size());
+    return std::fclose(file) == 0 && success;
+}
+
+bool CharacterizationHistory::append(const MotorKey& key, const FeedforwardConstants& constants,
+                                     double rSquared, std::uint32_t dataPoints, std::uint32_t durationMs,
+                                     HistoryTestType testType, std::uint8_t runCount) {
+    if (!loaded) {
+        load();
+    }
+
+    HistoryRecord record;
+    std::memset(static_cast<void*>(&record), 0, sizeof(record));
+    record.magic = kRecordMagic;
+    record.sequence = nextSequence;
+    record.unixTime = static_cast<std::int64_t>(std::time(nullptr));
+    record.kS = constants.kS;
+    record.kV = constants.kV;
+    record.kA = constants.kA;
+    record.uptimeMs = pros::millis();
+    record.rSquared = static_cast<float>(rSquared);
+    record.dataPoints = dataPoints;
+    record.durationMs = durationMs;
+    record.key = key;
+    record.testType = testType;
+    record.runCount = runCount;
+    record.crc = crc32(&record, offsetof(HistoryRecord, crc));
+
+    // The record is flushed and closed before the index is touched, so a
+    // power loss can at worst leave an index that load() will rebuild.
+    std::FILE* file = std::fopen(dataPath.c_str(), "ab");
+    if (file == nullptr) return false;
+    bool success = std::fwrite(&record, sizeof(record), 1, file) == 1 && std::fflush(file) == 0;
+    long length = std::ftell(file);
+    success = std::fclose(file) == 0 && success;
+    if (!success) return false;
+
+    applyRecord(record);
+    coveredBytes = length;
+    saveIndex();
+    return true;
+}
+
+const HistoryIndexEntry* CharacterizationHistory::find(const MotorKey& key) const {
+    for (const auto& entry : entries) {
+        if (entry.key == key) return &entry;
+    }
+    return nullptr;
+}
+
+bool CharacterizationHistory::readAll(const MotorKey& key, std::vector<HistoryRecord>& records) const {
+    records.clear();
+    return scanRecords(dataPath, 0, [&](const HistoryRecord& record) {
+        if (record.key == key) records.push_back(record);
+    }) >= 0;
+}
+
+} // namespace motor_characterization
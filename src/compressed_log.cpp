@@ -0,0 +1,333 @@
+#include "compressed_log.hpp"
+#include <cstring>
+
+namespace motor_characterization {
+
+using namespace compressed_log;
+
+namespace {
+
+constexpr std::int32_t kInt32Limit = 2147483647;
+
+inline std::int16_t quantize16(double value, double scale) {
+    return static_cast<std::int16_t>(telemetry::toField(value, scale, -32768, 32767));
+}
+
+/**
+ * @brief Quantize a sample to the frame a sampler would have produced
+ */
+TelemetryFrame toFrame(const DataPoint& point) {
+    TelemetryFrame frame;
+    frame.time = telemetry::toField(point.timestamp, kTimestampScale, -kInt32Limit, kInt32Limit);
+    frame.command = quantize16(point.voltage, kVoltageScale);
+    frame.velocity = telemetry::toField(point.velocity, kVelocityScale, -kInt32Limit, kInt32Limit);
+    frame.acceleration = telemetry::toField(point.acceleration, kAccelerationScale, -kInt32Limit, kInt32Limit);
+    frame.applied = quantize16(point.appliedVoltage, kVoltageScale);
+    frame.battery = static_cast<std::uint16_t>(telemetry::toField(point.batteryVoltage, kVoltageScale, 0, 0xFFFF));
+    frame.current = quantize16(point.current, telemetry::kCurrentScale);
+    frame.faults = static_cast<std::uint16_t>(point.faults);
+    frame.status = point.saturated ? telemetry::kStatusSaturated : 0;
+    frame.channels = TELEMETRY_VELOCITY | TELEMETRY_APPLIED_VOLTAGE | TELEMETRY_CURRENT |
+                     (point.batteryVoltage > 0.0 ? static_cast<std::uint32_t>(TELEMETRY_BATTERY_VOLTAGE) : 0u);
+    return frame;
+}
+
+inline std::uint8_t* writeVarint(std::uint8_t* out, std::uint32_t value) {
+    while (value >= 0x80) {
+        *out++ = static_cast<std::uint8_t>(value | 0x80);
+        value >>= 7;
+    }
+    *out++ = static_cast<std::uint8_t>(value);
+    return out;
+}
+
+// Zigzag mapping keeps small negative deltas small once varint encoded
+inline std::uint32_t zigzagEncode(std::int32_t value) {
+    return (static_cast<std::uint32_t>(value) << 1) ^ static_cast<std::uint32_t>(value >> 31);
+}
+
+inline std::int32_t zigzagDecode(std::uint32_t value) {
+    return static_cast<std::int32_t>((value >> 1) ^ (~(value & 1) + 1));
+}
+
+} // namespace
+
+// CompressedLogWriter implementation
+CompressedLogWriter::CompressedLogWriter()
+    : file(nullptr), activeBlock(0), pendingBlock(-1), running(false), failed(false),
+      compressed(Lz4BlockCodec::compressBound(kBlockSize)), sampleCount(0),
+      rawBytes(0), writtenBytes(0) {}
+
+CompressedLogWriter::~CompressedLogWriter() {
+    if (isOpen()) close();
+}
+
+bool CompressedLogWriter::open(const std::string& filename) {
+    if (isOpen()) close();
+
+    file = std::fopen(filename.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    FileHeader header{kMagic, kVersion, static_cast<std::uint16_t>(kFieldCount)};
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1) {
+        std::fclose(file);
+        file = nullptr;
+        return false;
+    }
+    failed = false;
+
+    for (auto& block : blocks) {
+        block.size = 0;
+        block.samples = 0;
+        block.previous.fill(0);
+    }
+    activeBlock = 0;
+    pendingBlock = -1;
+    sampleCount = 0;
+    rawBytes = 0;
+    writtenBytes = sizeof(header);
+
+    running = true;
+    task = std::make_unique<pros::Task>([this] { compressionLoop(); }, "Log compressor");
+    return true;
+}
+
+void CompressedLogWriter::append(const DataPoint& point) {
+    if (file == nullptr) return;
+    append(toFrame(point));
+}
+
+void CompressedLogWriter::append(const TelemetryFrame& frame) {
+    if (file == nullptr) return;
+
+    Block& block = blocks[activeBlock];
+    const std::int32_t values[kFieldCount] = {
+        frame.time, frame.command, frame.velocity, frame.acceleration,
+        frame.applied, frame.battery, frame.status, frame.current,
+        frame.torque, frame.power, frame.efficiency, frame.temperature,
+        frame.position, frame.faults, frame.hardware, frame.channels
+    };
+
+    std::uint8_t* out = block.data.data() + block.size;
+    for (size_t field = 0; field < kFieldCount; ++field) {
+        // Wrap-around subtraction keeps the delta well defined for any pair of values
+        std::int32_t delta = static_cast<std::int32_t>(
+            static_cast<std::uint32_t>(values[field]) - static_cast<std::uint32_t>(block.previous[field]));
+        out = writeVarint(out, zigzagEncode(delta));
+        block.previous[field] = values[field];
+    }
+    block.size = out - block.data.data();
+    block.samples++;
+    sampleCount++;
+
+    if (block.size + kMaxRecordBytes > kBlockSize) {
+        submitActiveBlock();
+    }
+}
+
+void CompressedLogWriter::submitActiveBlock() {
+    // A block holds several seconds of samples, so the task is normally idle
+    // long before the next one is full. Only wait if it has fallen behind.
+    while (pendingBlock.load() != -1) {
+        pros::delay(1);
+    }
+
+    pendingBlock = static_cast<int>(activeBlock);
+    task->notify();
+
+    activeBlock ^= 1;
+    Block& next = blocks[activeBlock];
+    next.size = 0;
+    next.samples = 0;
+    next.previous.fill(0);
+}
+
+void CompressedLogWriter::writeBlock(Block& block) {
+    std::size_t size = codec.compress(block.data.data(), block.size, compressed.data(), compressed.size());
+    const std::uint8_t* payload = compressed.data();
+
+    // Store incompressible blocks as-is; readers detect this by equal sizes
+    if (size == 0 || size >= block.size) {
+        payload = block.data.data();
+        size = block.size;
+    }
+
+    BlockHeader header{static_cast<std::uint32_t>(block.size), static_cast<std::uint32_t>(size), block.samples};
+    if (std::fwrite(&header, sizeof(header), 1, file) != 1 ||
+        std::fwrite(payload, 1, size, file) != size ||
+        std::fflush(file) != 0) {
+        failed = true;
+    }
+
+    rawBytes += block.size;
+    writtenBytes += sizeof(header) + size;
+}
+
+void CompressedLogWriter::compressionLoop() {
+    while (true) {
+        pros::Task::notify_take(true, TIMEOUT_MAX);
+
+        int pending = pendingBlock.load();
+        if (pending >= 0) {
+            writeBlock(blocks[pending]);
+            pendingBlock = -1;
+        }
+
+        if (!running) break;
+    }
+}
+
+bool CompressedLogWriter::close() {
+    if (file == nullptr) {
+        return false;
+    }
+
+    if (blocks[activeBlock].samples > 0) {
+        submitActiveBlock();
+    }
+    while (pendingBlock.load() != -1) {
+        pros::delay(1);
+    }
+
+    running = false;
+    task->notify();
+    task->join();
+    task.reset();
+
+    bool success = !failed && std::fclose(file) == 0;
+    file = nullptr;
+    return success;
+}
+
+// CompressedLogReader implementation
+CompressedLogReader::CompressedLogReader()
+    : file(nullptr), rawSize(0), position(0), fieldCount(kFieldCount), remainingSamples(0), previous{} {}
+
+CompressedLogReader::~CompressedLogReader() {
+    close();
+}
+
+bool CompressedLogReader::open(const std::string& filename) {
+    close();
+
+    file = std::fopen(filename.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+
+    FileHeader header;
+    bool supported = std::fread(&header, sizeof(header), 1, file) == 1 && header.magic == kMagic &&
+        ((header.version == kVersion && header.fieldCount == kFieldCount) ||
+         (header.version == 2 && header.fieldCount == kVersion2FieldCount) ||
+         (header.version == 1 && header.fieldCount == kVersion1FieldCount));
+    if (!supported) {
+        close();
+        return false;
+    }
+    fieldCount = header.fieldCount;
+
+    compressed.resize(Lz4BlockCodec::compressBound(kBlockSize));
+    raw.resize(kBlockSize);
+    rawSize = 0;
+    position = 0;
+    remainingSamples = 0;
+    return true;
+}
+
+bool CompressedLogReader::loadBlock() {
+    BlockHeader header;
+    if (file == nullptr || std::fread(&header, sizeof(header), 1, file) != 1) {
+        return false;
+    }
+    if (header.rawSize > raw.size() || header.compressedSize > compressed.size()) {
+        return false;
+    }
+
+    if (header.compressedSize == header.rawSize) {
+        if (std::fread(raw.data(), 1, header.rawSize, file) != header.rawSize) return false;
+    } else {
+        if (std::fread(compressed.data(), 1, header.compressedSize, file) != header.compressedSize) return false;
+        long size = Lz4BlockCodec::decompress(compressed.data(), header.compressedSize, raw.data(), raw.size());
+        if (size != static_cast<long>(header.rawSize)) return false;
+    }
+
+    rawSize = header.rawSize;
+    position = 0;
+    remainingSamples = header.sampleCount;
+    previous.fill(0);
+    return true;
+}
+
+bool CompressedLogReader::next(TelemetryFrame& frame) {
+    while (remainingSamples == 0) {
+        if (!loadBlock()) return false;
+    }
+
+    std::int32_t values[kFieldCount];
+    for (size_t field = 0; field < fieldCount; ++field) {
+        std::uint32_t encoded = 0;
+        for (int shift = 0;; shift += 7) {
+            if (position >= rawSize || shift > 28) return false;
+            std::uint8_t byte = raw[position++];
+            encoded |= static_cast<std::uint32_t>(byte & 0x7F) << shift;
+            if (!(byte & 0x80)) break;
+        }
+        values[field] = static_cast<std::int32_t>(
+            static_cast<std::uint32_t>(previous[field]) + static_cast<std::uint32_t>(zigzagDecode(encoded)));
+        previous[field] = values[field];
+    }
+    remainingSamples--;
+
+    frame = TelemetryFrame();
+    frame.time = values[0];
+    frame.command = static_cast<std::int16_t>(values[1]);
+    frame.velocity = values[2];
+    frame.acceleration = values[3];
+    frame.channels = TELEMETRY_VELOCITY;
+    if (fieldCount >= kVersion2FieldCount) {
+        frame.applied = static_cast<std::int16_t>(values[4]);
+        frame.battery = static_cast<std::uint16_t>(values[5]);
+        frame.status = static_cast<std::uint8_t>(values[6]);
+        frame.channels |= TELEMETRY_APPLIED_VOLTAGE | TELEMETRY_BATTERY_VOLTAGE;
+    }
+    if (fieldCount == kFieldCount) {
+        frame.current = static_cast<std::int16_t>(values[7]);
+        frame.torque = static_cast<std::int16_t>(values[8]);
+        frame.power = static_cast<std::int16_t>(values[9]);
+        frame.efficiency = static_cast<std::uint8_t>(values[10]);
+        frame.temperature = static_cast<std::int8_t>(values[11]);
+        frame.position = values[12];
+        frame.faults = static_cast<std::uint16_t>(values[13]);
+        frame.hardware = static_cast<std::uint8_t>(values[14]);
+        frame.channels = static_cast<std::uint16_t>(values[15]);
+    }
+    return true;
+}
+
+bool CompressedLogReader::next(DataPoint& point) {
+    TelemetryFrame frame;
+    if (!next(frame)) return false;
+    point = DataPoint(frame);
+    return true;
+}
+
+size_t CompressedLogReader::readAll(SystemIdentification& sysId) {
+    size_t count = 0;
+    TelemetryFrame frame;
+    while (next(frame)) {
+        sysId.addDataPoint(frame);
+        count++;
+    }
+    return count;
+}
+
+void CompressedLogReader::close() {
+    if (file != nullptr) {
+        std::fclose(file);
+        file = nullptr;
+    }
+}
+
+} // namespace motor_characterization
@@ -0,0 +1,121 @@
+#include "csv_writer.hpp"
+#include <algorithm>
+#include <charconv>
+#include <cfloat>
+#include <cmath>
+#include <cstring>
+
+namespace motor_characterization {
+
+namespace {
+
+// Powers of ten for the fixed-point decimal formatter
+constexpr std::int64_t kPowersOfTen[CsvWriter::kMaxPrecision + 1] = {
+    1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000
+};
+
+// Longest field: sign, 19 integer digits, point, 9 fractional digits, separator
+constexpr std::size_t kMaxFieldLength = 32;
+
+} // namespace
+
+CsvWriter::CsvWriter(std::FILE* file, std::size_t bufferSize)
+    : file(file), buffer(std::max<std::size_t>(bufferSize, kMaxFieldLength * 2)),
+      used(0), rowHasField(false), failed(file == nullptr) {}
+
+void CsvWriter::reserve(std::size_t bytes) {
+    if (used + bytes > buffer.size()) {
+        flush();
+    }
+}
+
+void CsvWriter::beginField() {
+    if (rowHasField) {
+        buffer[used++] = ',';
+    }
+    rowHasField = true;
+}
+
+void CsvWriter::writeText(const char* text) {
+    std::size_t length = std::strlen(text);
+    reserve(length + 1);
+    beginField();
+
+    // Headers are short, but never overrun the buffer on a long one
+    while (length > 0) {
+        std::size_t chunk = std::min(length, buffer.size() - used);
+        std::memcpy(buffer.data() + used, text, chunk);
+        used += chunk;
+        text += chunk;
+        length -= chunk;
+        if (length > 0) flush();
+    }
+}
+
+void CsvWriter::writeField(double value, int precision) {
+    precision = std::clamp(precision, 0, kMaxPrecision);
+
+    // Scale to an integer number of the smallest printed unit. Values that do not
+    // fit in 64 bits (or are not finite) take the slow printf path instead, as do
+    // values within the scaling's rounding error of a tie, where printf rounds the
+    // exact binary value and could go the other way.
+    double scaled = value * static_cast<double>(kPowersOfTen[precision]);
+    double magnitude = std::fabs(scaled);
+    double tieDistance = std::fabs(magnitude - std::floor(magnitude) - 0.5);
+    if (!std::isfinite(scaled) || magnitude >= 9.0e18 ||
+        tieDistance <= 4.0 * DBL_EPSILON * (magnitude + 1.0)) {
+        char text[400];
+        std::snprintf(text, sizeof(text), "%.*f", precision, value);
+        writeText(text);
+        return;
+    }
+
+    reserve(kMaxFieldLength);
+    beginField();
+
+    char* out = buffer.data() + used;
+    char* end = buffer.data() + buffer.size();
+
+    // The sign comes from the value, so tiny negatives print as -0.000 like printf
+    if (std::signbit(value)) *out++ = '-';
+    std::int64_t fixed = std::llround(magnitude);
+
+    std::int64_t integerPart = fixed / kPowersOfTen[precision];
+    std::int64_t fractionPart = fixed % kPowersOfTen[precision];
+    out = std::to_chars(out, end, integerPart).ptr;
+
+    if (precision > 0) {
+        *out++ = '.';
+        // Write the fraction right-aligned and zero-padded to the precision
+        for (int digit = precision - 1; digit >= 0; --digit) {
+            out[digit] = static_cast<char>('0' + fractionPart % 10);
+            fractionPart /= 10;
+        }
+        out += precision;
+    }
+
+    used = out - buffer.data();
+}
+
+void CsvWriter::writeField(std::int64_t value) {
+    reserve(kMaxFieldLength);
+    beginField();
+    char* out = buffer.data() + used;
+    used = std::to_chars(out, buffer.data() + buffer.size(), value).ptr - buffer.data();
+}
+
+void CsvWriter::endRow() {
+    reserve(1);
+    buffer[used++] = '\n';
+    rowHasField = false;
+}
+
+bool CsvWriter::flush() {
+    if (used > 0 && !failed) {
+        failed = std::fwrite(buffer.data(), 1, used, file) != used;
+    }
+    used = 0;
+    return !failed;
+}
+
+} // namespace motor_characterization
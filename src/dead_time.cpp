@@ -0,0 +1,117 @@
+#include "dead_time.hpp"
+#include <algorithm>
+#include <cmath>
+#include "sufficient_statistics.hpp"
+
+namespace motor_characterization {
+
+DeadTimeEstimate DeadTimeEstimator::estimate(const SystemIdentification& sysId, int maxLag) {
+    DeadTimeEstimate result;
+    const auto& points = sysId.getDataPoints();
+    const std::size_t n = points.size();
+    if (maxLag < 0 || n < static_cast<std::size_t>(maxLag) + 10) {
+        return result;
+    }
+
+    std::vector<Eigen::Vector3d> x(n);
+    std::vector<double> y(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] = Eigen::Vector3d(frictionSign(points[i].velocity), points[i].velocity, points[i].acceleration);
+        y[i] = sysId.responseVoltage(points[i]);
+    }
+
+    // Lag 0 moments over all samples
+    Eigen::Matrix3d gram = Eigen::Matrix3d::Zero();
+    Eigen::Vector3d regressorSum = Eigen::Vector3d::Zero();
+    double responseSumSquares = 0.0;
+    double responseSum = 0.0;
+    for (std::size_t i = 0; i < n; ++i) {
+        gram.selfadjointView<Eigen::Upper>().rankUpdate(x[i]);
+        regressorSum += x[i];
+        responseSumSquares += y[i] * y[i];
+        responseSum += y[i];
+    }
+
+    result.residualVariance.assign(maxLag + 1, INFINITY);
+    double bestVariance = INFINITY;
+    for (int lag = 0; lag <= maxLag; ++lag) {
+        const std::size_t pairs = n - lag;
+        if (lag > 0) {
+            // Motion sample lag-1 and voltage sample n-lag leave the pairing
+            gram.selfadjointView<Eigen::Upper>().rankUpdate(x[lag - 1], -1.0);
+            regressorSum -= x[lag - 1];
+            responseSumSquares -= y[pairs] * y[pairs];
+            responseSum -= y[pairs];
+        }
+
+        Eigen::Vector3d cross = Eigen::Vector3d::Zero();
+        for (std::size_t i = 0; i < pairs; ++i) {
+            cross += x[i + lag] * y[i];
+        }
+
+        Eigen::Matrix3d full = gram.selfadjointView<Eigen::Upper>();
+        SufficientStatistics statistics(full, cross, regressorSum, responseSumSquares, responseSum,
+                                        static_cast<std::uint32_t>(pairs));
+        StatisticsFit fit = statistics.solve(TERM_ALL);
+        if (!fit.valid) continue;
+
+        double variance = fit.residualSumSquares / (pairs - 3);
+        result.residualVariance[lag] = variance;
+        if (lag == 0) result.rSquaredUnaligned = fit.rSquared;
+        if (variance < bestVariance) {
+            bestVariance = variance;
+            result.lagSamples = lag;
+            result.rSquaredAligned = fit.rSquared;
+        }
+    }
+    if (!std::isfinite(bestVariance)) {
+        return result;
+    }
+
+    // Timestamps restart at every profile segment, so take the sample
+    // period as the median step between consecutive samples
+    std::vector<double> steps;
+    steps.reserve(n);
+    for (std::size_t i = 1; i < n; ++i) {
+        double step = points[i].timestamp - points[i - 1].timestamp;
+        if (step > 0.0) steps.push_back(step);
+    }
+    if (steps.empty()) {
+        return result;
+    }
+    std::nth_element(steps.begin(), steps.begin() + steps.size() / 2, steps.end());
+    result.samplePeriod = steps[steps.size() / 2];
+
+    // Parabola through the neighbours for a sub-sample estimate
+    double offset = 0.0;
+    int best = result.lagSamples;
+    if (best > 0 && best < maxLag) {
+        double left = result.residualVariance[best - 1];
+        double right = result.residualVariance[best + 1];
+        double curvature = left - 2.0 * bestVariance + right;
+        if (std::isfinite(curvature) && curvature > 0.0) {
+            offset = std::clamp(0.5 * (left - right) / curvature, -0.5, 0.5);
+        }
+    }
+    result.lagSeconds = (best + offset) * result.samplePeriod;
+    result.valid = true;
+    return result;
+}
+
+void DeadTimeEstimator::align(const SystemIdentification& source, int lag, SystemIdentification& aligned) {
+    aligned = source;
+    aligned.clearData();
+    const auto& points = source.getDataPoints();
+    lag = std::max(lag, 0);
+    for (std::size_t i = 0; i + lag < points.size(); ++i) {
+        DataPoint point = points[i];
+        point.velocity = points[i + lag].velocity;
+        point.acceleration = points[i + lag].acceleration;
+        point.velocityVariance = points[i + lag].velocityVariance;
+        point.accelerationVariance = points[i + lag].accelerationVariance;
+        point.faults |= points[i + lag].faults;
+        aligned.addDataPoint(point);
+    }
+}
+
+} // namespace motor_characterization
@@ -0,0 +1,105 @@
+#include "endurance_monitor.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace motor_characterization {
+
+EnduranceMonitor::EnduranceMonitor(const EnduranceOptions& options, VoltageSource source)
+    : options(options), window(source), temperatureSum(0), temperatureCount(0), currentSquaredSum(0),
+      currentCount(0), state(ENDURANCE_WARMUP), windowCount(0), baseline(), baselineSpread(), smoothed(),
+      cusumHigh(), cusumLow() {}
+
+void EnduranceMonitor::add(const TelemetryFrame& frame) {
+    window.add(frame);
+    if (frame.channels & TELEMETRY_TEMPERATURE) {
+        temperatureSum += frame.temperature;
+        temperatureCount++;
+    }
+    if (frame.channels & TELEMETRY_CURRENT) {
+        currentSquaredSum += static_cast<std::int64_t>(frame.current) * frame.current;
+        currentCount++;
+    }
+}
+
+bool EnduranceMonitor::closeWindow(double endTime, EnduranceWindow& result) {
+    const StatisticsFit fit = window.solve(TERM_ALL);
+
+    result = EnduranceWindow();
+    result.index = windowCount++;
+    result.endTime = endTime;
+    result.samples = window.getCount();
+    result.meanTemperature = temperatureCount > 0 ? static_cast<double>(temperatureSum) / temperatureCount : 0.0;
+    result.rmsCurrent =
+        currentCount > 0 ? std::sqrt(static_cast<double>(currentSquaredSum) / currentCount) / 1000.0 : 0.0;
+
+    window.clear();
+    temperatureSum = 0;
+    temperatureCount = 0;
+    currentSquaredSum = 0;
+    currentCount = 0;
+
+    if (!fit.valid) {
+        result.state = state;
+        return false;
+    }
+    result.kS = fit.coefficients(0);
+    result.kV = fit.coefficients(1);
+    result.kA = fit.coefficients(2);
+    result.rSquared = fit.rSquared;
+
+    const double values[kTracked] = {result.kS, result.kV};
+    if (result.index < static_cast<std::uint32_t>(options.warmupWindows)) {
+        state = ENDURANCE_WARMUP;
+    } else if (baseline[0].getCount() < static_cast<std::uint32_t>(options.baselineWindows)) {
+        for (int i = 0; i < kTracked; ++i) {
+            baseline[i].add(values[i]);
+            smoothed[i] = baseline[i].getMean();
+        }
+        state = ENDURANCE_BASELINE;
+        if (baseline[0].getCount() == static_cast<std::uint32_t>(options.baselineWindows)) {
+            for (int i = 0; i < kTracked; ++i) {
+                baselineSpread[i] =
+                    std::max(baseline[i].getStdDev(), options.minRelativeSpread * std::fabs(baseline[i].getMean()));
+            }
+            state = ENDURANCE_MONITORING;
+        }
+    } else {
+        bool drifting = false;
+        bool worn = false;
+        for (int i = 0; i < kTracked; ++i) {
+            smoothed[i] += options.smoothing * (values[i] - smoothed[i]);
+            if (!(baselineSpread[i] > 0.0)) continue;
+            const double mean = baseline[i].getMean();
+            double z = (values[i] - mean) / baselineSpread[i];
+            cusumHigh[i] = std::max(0.0, cusumHigh[i] + z - options.cusumSlack);
+            cusumLow[i] = std::max(0.0, cusumLow[i] - z - options.cusumSlack);
+            bool significant = std::max(cusumHigh[i], cusumLow[i]) > options.cusumLimit;
+            drifting = drifting || significant;
+            if (significant && std::fabs(mean) > 0.0 &&
+                std::fabs(smoothed[i] - mean) >= options.wearThreshold * std::fabs(mean)) {
+                worn = true;
+            }
+        }
+        state = worn ? ENDURANCE_WORN : drifting ? ENDURANCE_DRIFTING : ENDURANCE_MONITORING;
+    }
+
+    result.smoothedKS = smoothed[0];
+    result.smoothedKV = smoothed[1];
+    result.driftKS = std::max(cusumHigh[0], cusumLow[0]);
+    result.driftKV = std::max(cusumHigh[1], cusumLow[1]);
+    result.state = state;
+    return true;
+}
+
+const char* EnduranceMonitor::describe(EnduranceState state) {
+    switch (state) {
+        case ENDURANCE_WARMUP: return "warm-up";
+        case ENDURANCE_BASELINE: return "baseline";
+        case ENDURANCE_MONITORING: return "monitoring";
+        case ENDURANCE_DRIFTING: return "drifting";
+        case ENDURANCE_WORN: return "worn";
+    }
+    return "unknown";
+}
+
+} // namespace motor_characterization
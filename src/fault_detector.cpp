@@ -0,0 +1,52 @@
+#include "fault_detector.hpp"
+#include <cmath>
+
+namespace motor_characterization {
+
+namespace {
+
+// Bit values of pros::motor_fault_e_t and pros::motor_flag_e_t, repeated
+// here so the detector builds without the PROS headers
+constexpr std::uint32_t kHardwareOverTemp = 0x01;
+constexpr std::uint32_t kHardwareDriverFault = 0x02;
+constexpr std::uint32_t kHardwareOverCurrent = 0x04;
+constexpr std::uint32_t kHardwareDriverOverCurrent = 0x08;
+constexpr std::uint32_t kFlagBusy = 0x01;
+constexpr std::uint32_t kFlagZeroVelocity = 0x02;
+
+} // namespace
+
+std::uint32_t FaultDetector::update(const MotorHealth& health, double velocity, double commandedVoltage) {
+    std::uint32_t faults = FAULT_NONE;
+
+    if (!health.valid || (health.flags & kFlagBusy)) {
+        stallCount = 0;
+        faults |= FAULT_NO_RESPONSE;
+        latched |= faults;
+        return faults;
+    }
+
+    if (health.faults & kHardwareOverTemp) faults |= FAULT_OVER_TEMP;
+    if (health.faults & kHardwareOverCurrent) faults |= FAULT_CURRENT_LIMIT;
+    if (health.faults & (kHardwareDriverFault | kHardwareDriverOverCurrent)) faults |= FAULT_DRIVER;
+
+    bool notTurning = std::fabs(velocity) < options.stallVelocity || (health.flags & kFlagZeroVelocity);
+    bool stallLike = health.current >= options.stallCurrent && notTurning &&
+                     std::fabs(commandedVoltage) >= options.stallVoltage;
+    stallCount = stallLike ? stallCount + 1 : 0;
+    if (stallCount >= options.stallTicks) faults |= FAULT_STALL;
+
+    latched |= faults;
+    return faults;
+}
+
+const char* FaultDetector::describe(std::uint32_t faults) {
+    if (faults & FAULT_DRIVER) return "driver fault";
+    if (faults & FAULT_STALL) return "stall";
+    if (faults & FAULT_OVER_TEMP) return "over temp";
+    if (faults & FAULT_CURRENT_LIMIT) return "current limit";
+    if (faults & FAULT_NO_RESPONSE) return "no response";
+    return "none";
+}
+
+} // namespace motor_characterization
@@ -0,0 +1,147 @@
+#include "feedforward.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+#include "api.h"
+
+#if defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
+namespace motor_characterization {
+
+void FeedforwardConstants::calculate(std::span<const double> velocities, std::span<const double> accelerations,
+                                     std::span<double> voltages) const {
+    // The Cortex-A9 has no double-precision SIMD; keep the loop branch-free so
+    // the compiler can at least pipeline it (and vectorize it on the host)
+    std::size_t count = std::min({velocities.size(), accelerations.size(), voltages.size()});
+    for (std::size_t i = 0; i < count; ++i) {
+        voltages[i] = kS * frictionSign(velocities[i], velocityDeadband) +
+                      kV * velocities[i] + kA * accelerations[i];
+    }
+}
+
+void FeedforwardConstants::calculate(std::span<const float> velocities, std::span<const float> accelerations,
+                                     std::span<float> voltages) const {
+    std::size_t count = std::min({velocities.size(), accelerations.size(), voltages.size()});
+    const float s = static_cast<float>(kS);
+    const float v = static_cast<float>(kV);
+    const float a = static_cast<float>(kA);
+    const float deadband = static_cast<float>(velocityDeadband);
+    std::size_t i = 0;
+
+#if defined(__ARM_NEON)
+    const float32x4_t kS4 = vdupq_n_f32(s);
+    const float32x4_t minusKS4 = vdupq_n_f32(-s);
+    const float32x4_t zero4 = vdupq_n_f32(0.0f);
+    const float32x4_t kV4 = vdupq_n_f32(v);
+    const float32x4_t kA4 = vdupq_n_f32(a);
+    const float32x4_t deadband4 = vdupq_n_f32(deadband);
+    const float32x4_t minusDeadband4 = vdupq_n_f32(-deadband);
+    for (; i + 4 <= count; i += 4) {
+        float32x4_t velocity = vld1q_f32(velocities.data() + i);
+        float32x4_t acceleration = vld1q_f32(accelerations.data() + i);
+        // Select +kS, -kS or 0 with comparison masks instead of branching
+        uint32x4_t positive = vcgtq_f32(velocity, deadband4);
+        uint32x4_t negative = vcltq_f32(velocity, minusDeadband4);
+        float32x4_t friction = vbslq_f32(positive, kS4, vbslq_f32(negative, minusKS4, zero4));
+        float32x4_t voltage = vmlaq_f32(vmlaq_f32(friction, kV4, velocity), kA4, acceleration);
+        vst1q_f32(voltages.data() + i, voltage);
+    }
+#endif
+
+    for (; i < count; ++i) {
+        float sign = static_cast<float>((velocities[i] > deadband) - (velocities[i] < -deadband));
+        voltages[i] = s * sign + v * velocities[i] + a * accelerations[i];
+    }
+}
+
+FixedPointFeedforward::FixedPointFeedforward(const FeedforwardConstants& constants)
+    : kSMillivolts(static_cast<std::int32_t>(std::lround(constants.kS * 1000.0))),
+      kV(toFixed(constants.kV * 1000.0)),
+      kA(toFixed(constants.kA * 1000.0)),
+      deadband(toFixed(constants.velocityDeadband)) {}
+
+std::int32_t FixedPointFeedforward::toFixed(double value) {
+    double scaled = std::round(value * (1 << kFractionBits));
+    return static_cast<std::int32_t>(std::clamp(scaled, -2147483648.0, 2147483647.0));
+}
+
+void FixedPointFeedforward::calculate(std::span<const std::int32_t> velocities,
+                                      std::span<const std::int32_t> accelerations,
+                                      std::span<std::int32_t> millivolts) const {
+    std::size_t count = std::min({velocities.size(), accelerations.size(), millivolts.size()});
+    std::size_t i = 0;
+
+#if defined(__ARM_NEON)
+    const int32x2_t kV2 = vdup_n_s32(kV);
+    const int32x2_t kA2 = vdup_n_s32(kA);
+    const int32x4_t kS4 = vdupq_n_s32(kSMillivolts);
+    const int32x4_t deadband4 = vdupq_n_s32(deadband);
+    const int32x4_t minusDeadband4 = vdupq_n_s32(-deadband);
+    for (; i + 4 <= count; i += 4) {
+        int32x4_t velocity = vld1q_s32(velocities.data() + i);
+        int32x4_t acceleration = vld1q_s32(accelerations.data() + i);
+
+        // 32x32->64 multiply-accumulate, then rounding narrow back to mV
+        int64x2_t low = vmlal_s32(vmull_s32(vget_low_s32(velocity), kV2), vget_low_s32(acceleration), kA2);
+        int64x2_t high = vmlal_s32(vmull_s32(vget_high_s32(velocity), kV2), vget_high_s32(acceleration), kA2);
+        int32x4_t linear = vcombine_s32(vrshrn_n_s64(low, 32), vrshrn_n_s64(high, 32));
+
+        // Comparison masks are -1 when true, so negative - positive is the sign
+        int32x4_t positive = vreinterpretq_s32_u32(vcgtq_s32(velocity, deadband4));
+        int32x4_t negative = vreinterpretq_s32_u32(vcltq_s32(velocity, minusDeadband4));
+        int32x4_t sign = vsubq_s32(negative, positive);
+        vst1q_s32(millivolts.data() + i, vmlaq_s32(linear, sign, kS4));
+    }
+#endif
+
+    for (; i < count; ++i) {
+        millivolts[i] = calculate(velocities[i], accelerations[i]);
+    }
+}
+
+void benchmarkFeedforward(const FeedforwardConstants& constants, std::size_t samples, int repetitions) {
+    // Synthetic trajectory sweeping through zero velocity
+    std::vector<double> velocities(samples), accelerations(samples), voltages(samples);
+    std::vector<float> velocitiesF(samples), accelerationsF(samples), voltagesF(samples);
+    std::vector<std::int32_t> velocitiesQ(samples), accelerationsQ(samples), millivolts(samples);
+    for (std::size_t i = 0; i < samples; ++i) {
+        double phase = 2.0 * M_PI * i / samples;
+        velocities[i] = 200.0 * std::sin(phase);
+        accelerations[i] = 200.0 * std::cos(phase);
+        velocitiesF[i] = static_cast<float>(velocities[i]);
+        accelerationsF[i] = static_cast<float>(accelerations[i]);
+        velocitiesQ[i] = FixedPointFeedforward::toFixed(velocities[i]);
+        accelerationsQ[i] = FixedPointFeedforward::toFixed(accelerations[i]);
+    }
+    FixedPointFeedforward fixed(constants);
+
+    auto time = [&](auto&& body) {
+        std::uint64_t start = pros::micros();
+        for (int r = 0; r < repetitions; ++r) body();
+        return static_cast<double>(pros::micros() - start) * 1000.0 / (static_cast<double>(samples) * repetitions);
+    };
+
+    double scalarNs = time([&] {
+        for (std::size_t i = 0; i < samples; ++i) {
+            voltages[i] = constants.calculate(velocities[i], accelerations[i]);
+        }
+    });
+    double checksum = voltages[samples / 3];
+    double batchNs = time([&] { constants.calculate(velocities, accelerations, voltages); });
+    double floatNs = time([&] { constants.calculate(velocitiesF, accelerationsF, voltagesF); });
+    double fixedNs = time([&] { fixed.calculate(velocitiesQ, accelerationsQ, millivolts); });
+
+    printf("\n=== FEEDFORWARD BENCHMARK (%zu samples) ===\n", samples);
+    printf("Scalar double: %.1f ns/sample\n", scalarNs);
+    printf("Batch double:  %.1f ns/sample\n", batchNs);
+    printf("Batch float:   %.1f ns/sample\n", floatNs);
+    printf("Batch fixed:   %.1f ns/sample\n", fixedNs);
+    printf("Check: %.3f V / %.3f V / %.3f V / %d mV\n", checksum, voltages[samples / 3],
+           voltagesF[samples / 3], static_cast<int>(millivolts[samples / 3]));
+    printf("=====================================\n\n");
+}
+
+} // namespace motor_characterization
@@ -0,0 +1,154 @@
+#include "feedforward_table.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace motor_characterization {
+
+namespace {
+
+constexpr std::uint32_t kTableMagic = 0x5446464D;  // "MFFT"
+constexpr int kErrorSweepPoints = 8;               // Test points per cell along each axis
+
+inline std::int32_t toMillivolts(double volts) {
+    return static_cast<std::int32_t>(std::lround(volts * 1000.0));
+}
+
+/**
+ * @brief Reciprocal of a grid step as used by the lookup
+ * @return 2^32 / step, or 0 if the step is too small to represent
+ */
+std::uint32_t stepReciprocal(double minimum, double maximum, std::uint16_t count) {
+    if (count < 2 || !(maximum > minimum)) return 0;
+    double step = (maximum - minimum) / (count - 1);
+    if (!(step > 1.0)) return 0;
+    // A step just above 1 still rounds to 2^32
+    double reciprocal = std::round(4294967296.0 / step);
+    if (!(reciprocal < 4294967296.0)) return 0;
+    return static_cast<std::uint32_t>(reciprocal);
+}
+
+/**
+ * @brief Distance from the first node to the last as seen by the lookup
+ * @return Span (Q16.16), or -1 if it does not fit
+ */
+std::int32_t gridRange(std::uint32_t reciprocal, std::uint16_t count) {
+    double range = std::floor((count - 1) * 4294967296.0 / reciprocal * 65536.0);
+    return range <= 2147483647.0 ? static_cast<std::int32_t>(range) : -1;
+}
+
+} // namespace
+
+FeedforwardTable::FeedforwardTable() : header{} {
+    header.magic = kTableMagic;
+}
+
+bool FeedforwardTable::generate(const Model& model, const FrictionStep& step, const FeedforwardTableSpec& spec) {
+    std::uint32_t velocityReciprocal = stepReciprocal(spec.velocityMin, spec.velocityMax, spec.velocityCount);
+    std::uint32_t accelerationReciprocal =
+        stepReciprocal(spec.accelerationMin, spec.accelerationMax, spec.accelerationCount);
+    if (velocityReciprocal == 0 || accelerationReciprocal == 0) {
+        return false;
+    }
+    std::int32_t velocityRange = gridRange(velocityReciprocal, spec.velocityCount);
+    std::int32_t accelerationRange = gridRange(accelerationReciprocal, spec.accelerationCount);
+    if (velocityRange < 0 || accelerationRange < 0) {
+        return false;
+    }
+
+    header.magic = kTableMagic;
+    header.velocityCount = spec.velocityCount;
+    header.accelerationCount = spec.accelerationCount;
+    header.velocityMin = FixedPointFeedforward::toFixed(spec.velocityMin);
+    header.accelerationMin = FixedPointFeedforward::toFixed(spec.accelerationMin);
+    header.velocityReciprocal = velocityReciprocal;
+    header.accelerationReciprocal = accelerationReciprocal;
+    header.velocityRange = velocityRange;
+    header.accelerationRange = accelerationRange;
+    header.stepPositive = toMillivolts(step.positive);
+    header.stepNegative = toMillivolts(step.negative);
+    header.deadband = FixedPointFeedforward::toFixed(step.deadband);
+    header.maxErrorMicrovolts = 0;
+
+    // Node coordinates as the lookup sees them, so node values land exactly
+    auto velocityAt = [&](double index) { return spec.velocityMin + index * 4294967296.0 / velocityReciprocal; };
+    auto accelerationAt = [&](double index) {
+        return spec.accelerationMin + index * 4294967296.0 / accelerationReciprocal;
+    };
+
+    values.assign(static_cast<std::size_t>(spec.velocityCount) * spec.accelerationCount, 0);
+    for (std::uint16_t a = 0; a < spec.accelerationCount; ++a) {
+        for (std::uint16_t v = 0; v < spec.velocityCount; ++v) {
+            double velocity = velocityAt(v);
+            // Store only the continuous part; the lookup adds the step back exactly
+            double smooth = model(velocity, accelerationAt(a)) - step.evaluate(velocity);
+            double millivolts = std::round(smooth * 1000.0);
+            if (!(std::fabs(millivolts) <= 32767.0)) {
+                values.clear();
+                return false;
+            }
+            values[static_cast<std::size_t>(a) * spec.velocityCount + v] = static_cast<std::int16_t>(millivolts);
+        }
+    }
+
+    // Sweep interior and edge points of every cell against the model. Inputs
+    // are quantized first so only interpolation and storage error is measured.
+    FeedforwardTableView table = view();
+    auto quantize = [](double value) {
+        return FixedPointFeedforward::toFixed(value) / static_cast<double>(1 << FixedPointFeedforward::kFractionBits);
+    };
+    double maxError = 0.0;
+    const int velocityPoints = (spec.velocityCount - 1) * kErrorSweepPoints;
+    const int accelerationPoints = (spec.accelerationCount - 1) * kErrorSweepPoints;
+    for (int a = 0; a <= accelerationPoints; ++a) {
+        for (int v = 0; v <= velocityPoints; ++v) {
+            double velocity = quantize(velocityAt(static_cast<double>(v) / kErrorSweepPoints));
+            double acceleration = quantize(accelerationAt(static_cast<double>(a) / kErrorSweepPoints));
+            maxError = std::max(maxError, std::fabs(table.lookup(velocity, acceleration) - model(velocity, acceleration)));
+        }
+    }
+    header.maxErrorMicrovolts = static_cast<std::uint32_t>(std::min(std::ceil(maxError * 1e6), 4294967295.0));
+    return true;
+}
+
+bool FeedforwardTable::generate(const FeedforwardConstants& constants, const FeedforwardTableSpec& spec) {
+    FrictionStep step;
+    step.positive = constants.kS;
+    step.negative = constants.kS;
+    step.deadband = constants.velocityDeadband;
+    return generate([constants](double velocity, double acceleration) {
+        return constants.calculate(velocity, acceleration);
+    }, step, spec);
+}
+
+bool FeedforwardTable::exportSource(const std::string& filename, const std::string& name) const {
+    if (values.empty()) return false;
+
+    std::FILE* file = std::fopen(filename.c_str(), "w");
+    if (file == nullptr) return false;
+
+    std::fprintf(file, "// Generated feedforward table: %u x %u nodes, max error %.3f mV\n",
+                 header.velocityCount, header.accelerationCount, header.maxErrorMicrovolts / 1000.0);
+    std::fprintf(file, "#include \"feedforward_table.hpp\"\n\n");
+    std::fprintf(file, "static const std::int16_t %s_values[%zu] = {", name.c_str(), values.size());
+    for (std::size_t i = 0; i < values.size(); ++i) {
+        if (i % header.velocityCount == 0) std::fprintf(file, "\n   ");
+        std::fprintf(file, " %d,", values[i]);
+    }
+    std::fprintf(file, "\n};\n\n");
+    std::fprintf(file, "static const motor_characterization::FeedforwardTableHeader %s_header = {\n", name.c_str());
+    std::fprintf(file, "    0x%08lXu, %u, %u, %ld, %ld, %luu, %luu, %ld, %ld, %ld, %ld, %ld, %luu\n};\n\n",
+                 static_cast<unsigned long>(header.magic), header.velocityCount, header.accelerationCount,
+                 static_cast<long>(header.velocityMin), static_cast<long>(header.accelerationMin),
+                 static_cast<unsigned long>(header.velocityReciprocal),
+                 static_cast<unsigned long>(header.accelerationReciprocal),
+                 static_cast<long>(header.velocityRange), static_cast<long>(header.accelerationRange),
+                 static_cast<long>(header.stepPositive), static_cast<long>(header.stepNegative),
+                 static_cast<long>(header.deadband), static_cast<unsigned long>(header.maxErrorMicrovolts));
+    std::fprintf(file, "static const motor_characterization::FeedforwardTableView %s(&%s_header, %s_values);\n",
+                 name.c_str(), name.c_str(), name.c_str());
+
+    return std::fclose(file) == 0;
+}
+
+} // namespace motor_characterization
@@ -0,0 +1,142 @@
+#include "fixed_point_statistics.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+namespace motor_characterization {
+
+namespace {
+
+// Half a unit of each frame field, in physical units
+constexpr double kHalfMillivolt = 0.5 / telemetry::kVoltageScale;
+constexpr double kHalfVelocityUnit = 0.5 / telemetry::kVelocityScale;
+constexpr double kHalfAccelerationUnit = 0.5 / telemetry::kAccelerationScale;
+
+} // namespace
+
+void FixedPointStatistics::clear() {
+    for (std::int64_t& value : gram) value = 0;
+    for (int i = 0; i < 3; ++i) {
+        crossProduct[i] = 0;
+        regressorSum[i] = 0;
+    }
+    responseSumSquares = 0;
+    responseSum = 0;
+    count = 0;
+    rejected = 0;
+}
+
+bool FixedPointStatistics::add(std::int32_t velocity, std::int32_t acceleration, std::int32_t millivolts) {
+    if (std::abs(velocity) > kMaxVelocity || std::abs(acceleration) > kMaxAcceleration ||
+        std::abs(millivolts) > kMaxMillivolts || count >= kMaxSamples) {
+        rejected++;
+        return false;
+    }
+
+    const std::int64_t s = (velocity > 0) - (velocity < 0);
+    const std::int64_t v = velocity;
+    const std::int64_t a = acceleration;
+    const std::int64_t y = millivolts;
+    gram[0] += s * s;
+    gram[1] += s * v;
+    gram[2] += s * a;
+    gram[3] += v * v;
+    gram[4] += v * a;
+    gram[5] += a * a;
+    crossProduct[0] += s * y;
+    crossProduct[1] += v * y;
+    crossProduct[2] += a * y;
+    regressorSum[0] += s;
+    regressorSum[1] += v;
+    regressorSum[2] += a;
+    responseSumSquares += y * y;
+    responseSum += y;
+    count++;
+    return true;
+}
+
+bool FixedPointStatistics::add(const TelemetryFrame& frame) {
+    if (frame.faults != FAULT_NONE) return false;
+    if (voltageSource == VOLTAGE_COMMANDED && (frame.status & telemetry::kStatusSaturated)) return false;
+
+    std::int32_t millivolts = frame.command;
+    if (voltageSource == VOLTAGE_MEASURED && (frame.channels & TELEMETRY_APPLIED_VOLTAGE)) {
+        millivolts = frame.applied;
+    }
+    return add(frame.velocity, frame.acceleration, millivolts);
+}
+
+bool FixedPointStatistics::merge(const FixedPointStatistics& other) {
+    // Both sides stay within their own guards, so the sums cannot overflow while the count fits
+    if (static_cast<std::uint64_t>(count) + other.count > kMaxSamples) {
+        return false;
+    }
+    for (int i = 0; i < 6; ++i) gram[i] += other.gram[i];
+    for (int i = 0; i < 3; ++i) {
+        crossProduct[i] += other.crossProduct[i];
+        regressorSum[i] += other.regressorSum[i];
+    }
+    responseSumSquares += other.responseSumSquares;
+    responseSum += other.responseSum;
+    count += other.count;
+    rejected += other.rejected;
+    return true;
+}
+
+SufficientStatistics FixedPointStatistics::toStatistics() const {
+    const double scale[3] = {1.0, 1.0 / telemetry::kVelocityScale, 1.0 / telemetry::kAccelerationScale};
+    const double voltageScale = 1.0 / telemetry::kVoltageScale;
+    static constexpr int kRow[6] = {0, 0, 0, 1, 1, 2};
+    static constexpr int kColumn[6] = {0, 1, 2, 1, 2, 2};
+
+    // Upper triangle, as SufficientStatistics keeps it
+    Eigen::Matrix3d gramMatrix = Eigen::Matrix3d::Zero();
+    for (int k = 0; k < 6; ++k) {
+        gramMatrix(kRow[k], kColumn[k]) = static_cast<double>(gram[k]) * scale[kRow[k]] * scale[kColumn[k]];
+    }
+    Eigen::Vector3d cross;
+    Eigen::Vector3d regressors;
+    for (int i = 0; i < 3; ++i) {
+        cross(i) = static_cast<double>(crossProduct[i]) * scale[i] * voltageScale;
+        regressors(i) = static_cast<double>(regressorSum[i]) * scale[i];
+    }
+    return SufficientStatistics(gramMatrix, cross, regressors,
+                                static_cast<double>(responseSumSquares) * voltageScale * voltageScale,
+                                static_cast<double>(responseSum) * voltageScale, count);
+}
+
+Eigen::Vector3d FixedPointStatistics::quantizationBound(const StatisticsFit& fit, std::uint32_t terms) const {
+    Eigen::Vector3d bound = Eigen::Vector3d::Zero();
+    if (!fit.valid || count == 0) return bound;
+
+    // Worst-case response error per sample from rounding y, v and a
+    const double perSample = kHalfMillivolt + std::fabs(fit.coefficients(1)) * kHalfVelocityUnit +
+                             std::fabs(fit.coefficients(2)) * kHalfAccelerationUnit;
+
+    // Diagonal of the sub-model's (X^T X)^-1, Jacobi scaled as in SufficientStatistics::solve
+    const Eigen::Matrix3d full = toStatistics().getGram();
+    Eigen::Vector3d scale = Eigen::Vector3d::Ones();
+    Eigen::Matrix3d sub = Eigen::Matrix3d::Identity();
+    for (int i = 0; i < 3; ++i) {
+        if (!(terms & (1u << i))) continue;
+        if (!(full(i, i) > 0.0)) return bound;
+        scale(i) = 1.0 / std::sqrt(full(i, i));
+    }
+    for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < 3; ++j) {
+            if ((terms & (1u << i)) && (terms & (1u << j))) sub(i, j) = full(i, j) * scale(i) * scale(j);
+        }
+    }
+    Eigen::LDLT<Eigen::Matrix3d> ldlt(sub);
+    if (ldlt.info() != Eigen::Success) return bound;
+    const Eigen::Matrix3d inverse = ldlt.solve(Eigen::Matrix3d::Identity());
+
+    for (int j = 0; j < 3; ++j) {
+        if (!(terms & (1u << j))) continue;
+        double diagonal = inverse(j, j) * scale(j) * scale(j);
+        bound(j) = perSample * std::sqrt(std::max(count * diagonal, 0.0));
+    }
+    return bound;
+}
+
+} // namespace motor_characterization
@@ -0,0 +1,155 @@
+#include "frequency_response.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace motor_characterization {
+
+namespace {
+
+constexpr double kTwoPi = 6.283185307179586;
+
+} // namespace
+
+// ExcitationSignal implementation
+ExcitationSignal ExcitationSignal::multisine(const std::vector<double>& frequencies, double offset, double peak,
+                                             double sampleRate, std::size_t periodSamples) {
+    ExcitationSignal signal(offset, std::max<std::size_t>(periodSamples, 1));
+
+    // Schroeder phases keep the crest factor low, so each tone gets more of the voltage range
+    const double count = static_cast<double>(frequencies.size());
+    for (std::size_t k = 0; k < frequencies.size(); ++k) {
+        double phase = -M_PI * k * (k + 1) / count;
+        signal.tones.push_back({kTwoPi * frequencies[k] / sampleRate, 1.0, phase});
+    }
+
+    // Scale to the requested peak, measured over one period
+    double largest = 0.0;
+    for (std::size_t n = 0; n < signal.periodSamples; ++n) {
+        largest = std::max(largest, std::fabs(signal.voltageAt(n) - offset));
+    }
+    if (largest > 0.0) {
+        for (auto& tone : signal.tones) tone.amplitude = peak / largest;
+    }
+    return signal;
+}
+
+double ExcitationSignal::voltageAt(std::size_t sample) const {
+    const double n = static_cast<double>(sample % periodSamples);
+    double voltage = offset;
+    for (const auto& tone : tones) {
+        voltage += tone.amplitude * std::sin(tone.frequency * n + tone.phase);
+    }
+    return voltage;
+}
+
+// GoertzelBin implementation
+void GoertzelBin::configure(double frequency, double sampleRate) {
+    omega = kTwoPi * frequency / sampleRate;
+    coefficient = 2.0 * std::cos(omega);
+    s1 = 0.0;
+    s2 = 0.0;
+}
+
+// FrequencyResponseEstimator implementation
+FrequencyResponseEstimator::FrequencyResponseEstimator(const std::vector<double>& frequencies, double sampleRate)
+    : frequencies(frequencies), voltageBins(frequencies.size()), velocityBins(frequencies.size()),
+      voltageSum(0.0), velocitySum(0.0), sampleCount(0) {
+    for (std::size_t k = 0; k < frequencies.size(); ++k) {
+        voltageBins[k].configure(frequencies[k], sampleRate);
+        velocityBins[k].configure(frequencies[k], sampleRate);
+    }
+}
+
+void FrequencyResponseEstimator::add(double voltage, double velocity) {
+    for (std::size_t k = 0; k < frequencies.size(); ++k) {
+        voltageBins[k].add(voltage);
+        velocityBins[k].add(velocity);
+    }
+    voltageSum += voltage;
+    velocitySum += velocity;
+    sampleCount++;
+}
+
+std::vector<FrequencyPoint> FrequencyResponseEstimator::getResponse() const {
+    std::vector<FrequencyPoint> points;
+    points.reserve(frequencies.size());
+    for (std::size_t k = 0; k < frequencies.size(); ++k) {
+        std::complex<double> voltage = voltageBins[k].result();
+        std::complex<double> response = std::abs(voltage) > 0.0 ? velocityBins[k].result() / voltage : 0.0;
+        points.push_back({frequencies[k], response, std::abs(response), std::arg(response) * 180.0 / M_PI});
+    }
+    return points;
+}
+
+FrequencyResponseFit FrequencyResponseEstimator::fit(double maxDeadTime) const {
+    FrequencyResponseFit result = {};
+    if (frequencies.size() < 2 || sampleCount < 2) {
+        return result;
+    }
+
+    double velocityPower = 0.0;      // sum |v_k|^2
+    double accelerationPower = 0.0;  // sum w_k^2 |v_k|^2
+    double voltagePower = 0.0;       // sum |V_k|^2
+    for (std::size_t k = 0; k < frequencies.size(); ++k) {
+        double w = kTwoPi * frequencies[k];
+        double power = std::norm(velocityBins[k].result());
+        velocityPower += power;
+        accelerationPower += w * w * power;
+        voltagePower += std::norm(voltageBins[k].result());
+    }
+    if (!(velocityPower > 0.0) || !(accelerationPower > 0.0) || !(voltagePower > 0.0)) {
+        return result;
+    }
+
+    // Equation error |V_k e^{-j w tau} - (kV + j w kA) v_k|^2 is linear in kV
+    // and kA, and the two columns v_k and j w v_k are orthogonal
+    double bestResidual = INFINITY;
+    int steps = std::max(0, static_cast<int>(std::lround(maxDeadTime * 1000.0)));
+    for (int step = 0; step <= steps; ++step) {
+        double tau = step / 1000.0;
+        std::complex<double> velocityProjection = 0.0;
+        std::complex<double> accelerationProjection = 0.0;
+        for (std::size_t k = 0; k < frequencies.size(); ++k) {
+            double w = kTwoPi * frequencies[k];
+            std::complex<double> shifted = voltageBins[k].result() * std::polar(1.0, -w * tau);
+            std::complex<double> velocity = velocityBins[k].result();
+            velocityProjection += std::conj(velocity) * shifted;
+            accelerationProjection += std::conj(std::complex<double>(0.0, w) * velocity) * shifted;
+        }
+        double kV = velocityProjection.real() / velocityPower;
+        double kA = accelerationProjection.real() / accelerationPower;
+        double residual = voltagePower - kV * kV * velocityPower - kA * kA * accelerationPower;
+        if (residual < bestResidual) {
+            bestResidual = residual;
+            result.kV = kV;
+            result.kA = kA;
+            result.deadTime = tau;
+        }
+    }
+
+    // Static friction from the means (mean acceleration is zero over whole periods)
+    result.kS = voltageSum / sampleCount - result.kV * velocitySum / sampleCount;
+    result.relativeError = std::sqrt(std::max(bestResidual, 0.0) / voltagePower);
+    result.valid = std::isfinite(result.kV) && std::isfinite(result.kA);
+    return result;
+}
+
+std::vector<double> FrequencyResponseEstimator::logFrequencies(double low, double high, std::size_t count,
+                                                               double recordSeconds) {
+    std::vector<double> result;
+    if (count == 0 || !(low > 0.0) || !(high >= low) || !(recordSeconds > 0.0)) {
+        return result;
+    }
+    const double resolution = 1.0 / recordSeconds;
+    for (std::size_t i = 0; i < count; ++i) {
+        double fraction = count > 1 ? static_cast<double>(i) / (count - 1) : 0.0;
+        double frequency = low * std::pow(high / low, fraction);
+        double snapped = std::max(1.0, std::round(frequency / resolution)) * resolution;
+        if (result.empty() || snapped > result.back() + resolution / 2) {
+            result.push_back(snapped);
+        }
+    }
+    return result;
+}
+
+} // namespace motor_characterization
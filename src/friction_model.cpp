@@ -0,0 +1,173 @@
+#include "friction_model.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <Eigen/Dense>
+
+namespace motor_characterization {
+
+namespace {
+
+constexpr int kLinearTerms = 6;  // coulomb +/-, stribeck +/-, kV, kA
+constexpr int kTerms = 7;        // plus the Stribeck velocity
+
+// Stribeck velocities tried before the joint refinement (RPM)
+constexpr double kStribeckGrid[] = {2.0, 4.0, 8.0, 15.0, 25.0, 40.0, 70.0, 120.0};
+
+constexpr int kMaxStepHalvings = 5;
+
+using LinearVector = Eigen::Matrix<double, kLinearTerms, 1>;
+using LinearMatrix = Eigen::Matrix<double, kLinearTerms, kLinearTerms>;
+using Vector = Eigen::Matrix<double, kTerms, 1>;
+using Matrix = Eigen::Matrix<double, kTerms, kTerms>;
+
+/**
+ * @brief Regressors of the linear constants at one sample for a Stribeck velocity
+ */
+LinearVector regressors(double velocity, double acceleration, double stribeckVelocity, double deadband) {
+    const double forward = velocity > deadband;
+    const double reverse = velocity < -deadband;
+    const double x = velocity / stribeckVelocity;
+    const double decay = std::exp(-x * x);
+    LinearVector row;
+    row << forward, -reverse, forward * decay, -reverse * decay, velocity, acceleration;
+    return row;
+}
+
+FrictionModel toModel(const Vector& theta, double deadband) {
+    FrictionModel model;
+    model.coulombForward = theta(0);
+    model.coulombReverse = theta(1);
+    model.stribeckForward = theta(2);
+    model.stribeckReverse = theta(3);
+    model.kV = theta(4);
+    model.kA = theta(5);
+    model.stribeckVelocity = theta(6);
+    model.velocityDeadband = deadband;
+    return model;
+}
+
+} // namespace
+
+FrictionModelFit fitFrictionModel(const SystemIdentification& sysId, const FeedforwardConstants& seed,
+                                  int iterations) {
+    FrictionModelFit result;
+    const auto& points = sysId.getDataPoints();
+    const double deadband = seed.velocityDeadband;
+
+    // Response moments and the seed's residuals, shared by every candidate
+    double responseSum = 0.0;
+    double responseSumSquares = 0.0;
+    double linearResidualSumSquares = 0.0;
+    std::uint32_t count = 0;
+    for (const auto& point : points) {
+        if (!sysId.isUsable(point)) continue;
+        const double y = sysId.responseVoltage(point);
+        const double residual = y - seed.calculate(point.velocity, point.acceleration);
+        responseSum += y;
+        responseSumSquares += y * y;
+        linearResidualSumSquares += residual * residual;
+        count++;
+    }
+    if (count <= kTerms) return result;
+
+    // Exact linear solve at each grid velocity; keep the best
+    Vector theta = Vector::Zero();
+    double bestResidual = INFINITY;
+    for (double stribeckVelocity : kStribeckGrid) {
+        LinearMatrix normal = LinearMatrix::Zero();
+        LinearVector cross = LinearVector::Zero();
+        for (const auto& point : points) {
+            if (!sysId.isUsable(point)) continue;
+            const LinearVector row = regressors(point.velocity, point.acceleration, stribeckVelocity, deadband);
+            normal.selfadjointView<Eigen::Upper>().rankUpdate(row);
+            cross += row * sysId.responseVoltage(point);
+        }
+        const LinearMatrix full = normal.selfadjointView<Eigen::Upper>();
+        Eigen::LDLT<LinearMatrix> ldlt(full);
+        if (ldlt.info() != Eigen::Success || !(ldlt.rcond() > 1e-12)) continue;
+        const LinearVector coefficients = ldlt.solve(cross);
+        const double residual = responseSumSquares - coefficients.dot(cross);
+        if (residual < bestResidual) {
+            bestResidual = residual;
+            theta << coefficients, stribeckVelocity;
+        }
+    }
+    if (!std::isfinite(bestResidual)) return result;
+
+    // Joint Gauss-Newton on all seven constants
+    auto accumulate = [&](const Vector& p, Matrix* normal, Vector* gradient) {
+        if (normal != nullptr) {
+            normal->setZero();
+            gradient->setZero();
+        }
+        double sumSquares = 0.0;
+        for (const auto& point : points) {
+            if (!sysId.isUsable(point)) continue;
+            const LinearVector row = regressors(point.velocity, point.acceleration, p(6), deadband);
+            const double residual = sysId.responseVoltage(point) - row.dot(p.head<kLinearTerms>());
+            sumSquares += residual * residual;
+            if (normal != nullptr) {
+                // d/dvs of stribeck * exp(-(v/vs)^2) = stribeck * exp(...) * 2 v^2 / vs^3
+                const double v = point.velocity;
+                const double scale = 2.0 * v * v / (p(6) * p(6) * p(6));
+                Vector j;
+                j << row, (p(2) * row(2) + p(3) * row(3)) * scale;
+                normal->selfadjointView<Eigen::Upper>().rankUpdate(j);
+                *gradient += j * residual;
+            }
+        }
+        return sumSquares;
+    };
+
+    Matrix normal;
+    Vector gradient;
+    double sumSquares = accumulate(theta, &normal, &gradient);
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        const Matrix full = normal.selfadjointView<Eigen::Upper>();
+        Eigen::LDLT<Matrix> ldlt(full);
+        if (ldlt.info() != Eigen::Success) break;
+        Vector step = ldlt.solve(gradient);
+        bool improved = false;
+        for (int halving = 0; halving < kMaxStepHalvings && !improved; ++halving, step *= 0.5) {
+            const Vector candidate = theta + step;
+            if (!(candidate(6) > 0.0)) continue;
+            const double candidateSumSquares = accumulate(candidate, nullptr, nullptr);
+            if (candidateSumSquares < sumSquares) {
+                theta = candidate;
+                sumSquares = candidateSumSquares;
+                improved = true;
+            }
+        }
+        result.iterations = iteration + 1;
+        if (!improved) break;
+        accumulate(theta, &normal, &gradient);
+    }
+
+    const double totalSumSquares = responseSumSquares - responseSum * responseSum / count;
+    result.model = toModel(theta, deadband);
+    result.residualSumSquares = sumSquares;
+    result.linearResidualSumSquares = linearResidualSumSquares;
+    result.rSquared = totalSumSquares > 0.0 ? 1.0 - sumSquares / totalSumSquares : 0.0;
+    result.samples = count;
+    result.valid = theta.allFinite();
+    return result;
+}
+
+void printFrictionModel(const FrictionModelFit& fit) {
+    if (!fit.valid) {
+        printf("\nFriction model: needs samples in both directions\n");
+        return;
+    }
+    const FrictionModel& model = fit.model;
+    const double reduction =
+        fit.linearResidualSumSquares > 0.0 ? 1.0 - fit.residualSumSquares / fit.linearResidualSumSquares : 0.0;
+    printf("\nFriction model (Coulomb + Stribeck + viscous, %d iterations):\n", fit.iterations);
+    printf("            Coulomb    Breakaway\n");
+    printf("  Forward   %.4f V   %.4f V\n", model.coulombForward, model.breakaway(true));
+    printf("  Reverse   %.4f V   %.4f V\n", model.coulombReverse, model.breakaway(false));
+    printf("  Stribeck velocity: %.1f RPM\n", model.stribeckVelocity);
+    printf("  kV: %.4f V/RPM, kA: %.6f V/(RPM/s)\n", model.kV, model.kA);
+    printf("  R-squared: %.4f (residuals %.1f%% below the linear model)\n", fit.rSquared, reduction * 100.0);
+}
+
+} // namespace motor_characterization
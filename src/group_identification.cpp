@@ -0,0 +1,113 @@
+#include "group_identification.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace motor_characterization {
+
+namespace {
+
+/**
+ * @brief Median of a few values
+ */
+double median(const double* values, int count) {
+    double sorted[kMaxGroupMembers];
+    std::copy(values, values + count, sorted);
+    std::sort(sorted, sorted + count);
+    return count % 2 == 1 ? sorted[count / 2] : 0.5 * (sorted[count / 2 - 1] + sorted[count / 2]);
+}
+
+/**
+ * @brief How far a value sits above a reference, relative to the reference
+ */
+double relativeExcess(double value, double reference) {
+    if (!(std::fabs(reference) > 1e-9)) return 0.0;
+    return std::max((value - reference) / std::fabs(reference), 0.0);
+}
+
+} // namespace
+
+GroupIdentification::GroupIdentification(int members, double dragThreshold)
+    : memberCount(std::clamp(members, 0, kMaxGroupMembers)), dragThreshold(dragThreshold),
+      voltageSource(VOLTAGE_COMMANDED), absoluteCurrentSum(), absoluteSpeedSum(), results(), draggingMember(-1) {}
+
+void GroupIdentification::add(const GroupSample& sample) {
+    if (sample.members != memberCount || memberCount == 0) return;
+    if (sample.faults != FAULT_NONE) return;
+    if (voltageSource == VOLTAGE_COMMANDED && sample.saturated) return;
+
+    double velocity = 0.0;
+    double acceleration = 0.0;
+    double applied = 0.0;
+    for (int i = 0; i < memberCount; ++i) {
+        double memberVoltage = voltageSource == VOLTAGE_MEASURED ? sample.applied[i] : sample.commanded;
+        voltageStatistics[i].add(sample.velocity[i], sample.acceleration[i], memberVoltage);
+        currentStatistics[i].add(sample.velocity[i], sample.acceleration[i], sample.current[i]);
+        absoluteCurrentSum[i] += std::fabs(sample.current[i]);
+        absoluteSpeedSum[i] += std::fabs(sample.velocity[i]);
+        velocity += sample.velocity[i];
+        acceleration += sample.acceleration[i];
+        applied += memberVoltage;
+    }
+    combined.add(velocity / memberCount, acceleration / memberCount, applied / memberCount);
+}
+
+bool GroupIdentification::identify() {
+    draggingMember = -1;
+    combinedFit = combined.solve(TERM_ALL);
+    const std::uint32_t samples = combined.getCount();
+    if (!combinedFit.valid || samples == 0) {
+        return false;
+    }
+
+    double totalCurrent = 0.0;
+    double totalSpeed = 0.0;
+    double currents[kMaxGroupMembers];
+    double validFriction[kMaxGroupMembers];
+    double validHolding[kMaxGroupMembers];
+    int frictionCount = 0;
+    int holdingCount = 0;
+    for (int i = 0; i < memberCount; ++i) {
+        GroupMemberResult& result = results[i];
+        result.fit = voltageStatistics[i].solve(TERM_ALL);
+        result.currentFit = currentStatistics[i].solve(TERM_ALL);
+        result.meanCurrent = absoluteCurrentSum[i] / samples;
+        totalCurrent += result.meanCurrent;
+        totalSpeed += absoluteSpeedSum[i] / samples;
+        currents[i] = result.meanCurrent;
+        if (result.fit.valid) validFriction[frictionCount++] = result.fit.coefficients(0);
+        if (result.currentFit.valid) validHolding[holdingCount++] = result.currentFit.coefficients(0);
+    }
+
+    // Compare every member against the group median, which a single bad
+    // member cannot pull towards itself. Fitted terms only count from valid
+    // fits, and are only compared when at least two members have one.
+    const bool compareFriction = frictionCount >= 2;
+    const bool compareHolding = holdingCount >= 2;
+    const double medianFriction = compareFriction ? median(validFriction, frictionCount) : 0.0;
+    const double medianCurrent = median(currents, memberCount);
+    const double medianHolding = compareHolding ? median(validHolding, holdingCount) : 0.0;
+    const double meanSpeed = totalSpeed / memberCount;
+    double worstScore = 0.0;
+    for (int i = 0; i < memberCount; ++i) {
+        GroupMemberResult& result = results[i];
+        result.share = totalCurrent > 0.0 ? result.meanCurrent / totalCurrent : 0.0;
+        result.speedRatio = meanSpeed > 0.0 ? (absoluteSpeedSum[i] / samples) / meanSpeed : 1.0;
+
+        double score = std::max(relativeExcess(currents[i], medianCurrent), 1.0 - result.speedRatio);
+        if (compareFriction && result.fit.valid) {
+            score = std::max(score, relativeExcess(result.fit.coefficients(0), medianFriction));
+        }
+        if (compareHolding && result.currentFit.valid) {
+            score = std::max(score, relativeExcess(result.currentFit.coefficients(0), medianHolding));
+        }
+        result.dragScore = score;
+
+        if (score > dragThreshold && score > worstScore) {
+            worstScore = score;
+            draggingMember = i;
+        }
+    }
+    return true;
+}
+
+} // namespace motor_characterization
@@ -0,0 +1,64 @@
+#include "group_sampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include "motor_sampler.hpp"
+
+namespace motor_characterization {
+
+GroupSampler::GroupSampler(pros::MotorGroup& group)
+    : group(group), memberCount(std::min<int>(group.size(), kMaxGroupMembers)), previousTime(0.0),
+      previousVelocity() {}
+
+bool GroupSampler::sample(int commandMillivolts, double time, GroupSample& sample) {
+    // One batch call per quantity for the whole group
+    std::vector<double> velocities = group.get_actual_velocity_all();
+    std::vector<std::int32_t> currents = group.get_current_draw_all();
+    std::vector<std::int32_t> voltages = group.get_voltage_all();
+    std::int32_t batteryMillivolts = pros::battery::get_voltage();
+
+    double commanded = commandMillivolts / 1000.0;
+    double battery = batteryMillivolts == PROS_ERR ? 0.0 : batteryMillivolts / 1000.0;
+    double previousT = previousTime;
+    double dt = time - previousT;
+    previousTime = time;
+
+    sample = GroupSample();
+    sample.commanded = commanded;
+    sample.timestamp = time;
+    sample.members = memberCount;
+    for (int i = 0; i < memberCount; ++i) {
+        bool read = static_cast<std::size_t>(i) < velocities.size() && static_cast<std::size_t>(i) < currents.size() &&
+                    static_cast<std::size_t>(i) < voltages.size() && currents[i] != PROS_ERR &&
+                    voltages[i] != PROS_ERR && std::isfinite(velocities[i]);
+
+        MotorHealth health;
+        health.valid = read;
+        health.current = read ? currents[i] : 0;
+        double velocity = read ? velocities[i] : previousVelocity[i];
+        std::uint32_t memberFaults = detectors[i].update(health, velocity, commanded);
+        if (detectors[i].isMasked(memberFaults)) sample.faults |= memberFaults;
+
+        sample.velocity[i] = velocity;
+        sample.acceleration[i] = dt > 0.001 ? (velocity - previousVelocity[i]) / dt : 0.0;
+        sample.applied[i] = read ? voltages[i] / 1000.0 : commanded;
+        sample.current[i] = read ? currents[i] / 1000.0 : 0.0;
+        sample.saturated = sample.saturated || MotorSampler::isSaturated(commanded, sample.applied[i], battery);
+        previousVelocity[i] = velocity;
+    }
+    return previousT > 0 && dt > 0.001;
+}
+
+bool GroupSampler::shouldAbort() const {
+    for (int i = 0; i < memberCount; ++i) {
+        if (detectors[i].shouldAbort()) return true;
+    }
+    return false;
+}
+
+std::uint32_t GroupSampler::getLatchedFaults() const {
+    std::uint32_t faults = FAULT_NONE;
+    for (int i = 0; i < memberCount; ++i) faults |= detectors[i].getLatchedFaults();
+    return faults;
+}
+
+} // namespace motor_characterization
@@ -0,0 +1,170 @@
+#include "lz4_block.hpp"
+#include <algorithm>
+#include <cstring>
+
+namespace motor_characterization {
+
+namespace {
+
+// LZ4 block format constants (see lz4_Block_format.md in the reference sources)
+constexpr std::size_t kMinMatch = 4;
+constexpr std::size_t kLastLiterals = 5;    // Last 5 bytes are always literals
+constexpr std::size_t kMatchFindLimit = 12; // Last match starts at least 12 bytes before the end
+constexpr std::size_t kMaxOffset = 65535;
+
+inline std::uint32_t read32(const std::uint8_t* p) {
+    std::uint32_t value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+inline std::uint32_t hashSequence(std::uint32_t sequence, int hashLog) {
+    return (sequence * 2654435761u) >> (32 - hashLog);
+}
+
+// Bytes needed to store a length that overflows its 4-bit token field
+inline std::size_t extraLengthBytes(std::size_t length) {
+    return length >= 15 ? (length - 15) / 255 + 1 : 0;
+}
+
+inline std::uint8_t* writeExtraLength(std::uint8_t* op, std::size_t length) {
+    if (length < 15) return op;
+    length -= 15;
+    while (length >= 255) {
+        *op++ = 255;
+        length -= 255;
+    }
+    *op++ = static_cast<std::uint8_t>(length);
+    return op;
+}
+
+} // namespace
+
+std::size_t Lz4BlockCodec::compress(const std::uint8_t* src, std::size_t srcSize,
+                                    std::uint8_t* dst, std::size_t dstCapacity) {
+    if (srcSize > kMaxBlockSize) return 0;
+
+    std::uint8_t* op = dst;
+    std::uint8_t* const opEnd = dst + dstCapacity;
+    std::size_t anchor = 0;
+
+    if (srcSize > kMatchFindLimit) {
+        std::fill(hashTable.begin(), hashTable.end(), 0);
+
+        const std::size_t matchStartLimit = srcSize - kMatchFindLimit;
+        const std::size_t matchEndLimit = srcSize - kLastLiterals;
+        std::size_t ip = 1;
+        hashTable[hashSequence(read32(src), kHashLog)] = 0;
+
+        while (ip <= matchStartLimit) {
+            std::uint32_t sequence = read32(src + ip);
+            std::uint32_t hash = hashSequence(sequence, kHashLog);
+            std::size_t ref = hashTable[hash];
+            hashTable[hash] = static_cast<std::uint16_t>(ip);
+
+            if (ip - ref > kMaxOffset || read32(src + ref) != sequence) {
+                ++ip;
+                continue;
+            }
+
+            // Extend the match backwards over pending literals, then forwards
+            while (ip > anchor && ref > 0 && src[ip - 1] == src[ref - 1]) {
+                --ip;
+                --ref;
+            }
+            std::size_t matchLength = kMinMatch;
+            while (ip + matchLength < matchEndLimit && src[ref + matchLength] == src[ip + matchLength]) {
+                ++matchLength;
+            }
+
+            std::size_t literalLength = ip - anchor;
+            std::size_t needed = 1 + extraLengthBytes(literalLength) + literalLength + 2 +
+                                 extraLengthBytes(matchLength - kMinMatch);
+            if (needed > static_cast<std::size_t>(opEnd - op)) return 0;
+
+            std::uint8_t* token = op++;
+            *token = static_cast<std::uint8_t>(std::min<std::size_t>(literalLength, 15) << 4);
+            op = writeExtraLength(op, literalLength);
+            std::memcpy(op, src + anchor, literalLength);
+            op += literalLength;
+
+            std::size_t offset = ip - ref;
+            *op++ = static_cast<std::uint8_t>(offset & 0xFF);
+            *op++ = static_cast<std::uint8_t>(offset >> 8);
+
+            *token |= static_cast<std::uint8_t>(std::min<std::size_t>(matchLength - kMinMatch, 15));
+            op = writeExtraLength(op, matchLength - kMinMatch);
+
+            ip += matchLength;
+            anchor = ip;
+
+            // Seed the table inside the match so the next search has a nearby candidate
+            if (ip - 2 <= matchStartLimit) {
+                hashTable[hashSequence(read32(src + ip - 2), kHashLog)] = static_cast<std::uint16_t>(ip - 2);
+            }
+        }
+    }
+
+    // Final sequence: the remaining bytes as literals with no match
+    std::size_t literalLength = srcSize - anchor;
+    if (1 + extraLengthBytes(literalLength) + literalLength > static_cast<std::size_t>(opEnd - op)) return 0;
+    *op++ = static_cast<std::uint8_t>(std::min<std::size_t>(literalLength, 15) << 4);
+    op = writeExtraLength(op, literalLength);
+    if (literalLength > 0) {
+        std::memcpy(op, src + anchor, literalLength);
+        op += literalLength;
+    }
+
+    return op - dst;
+}
+
+long Lz4BlockCodec::decompress(const std::uint8_t* src, std::size_t srcSize,
+                               std::uint8_t* dst, std::size_t dstCapacity) {
+    std::size_t ip = 0;
+    std::size_t op = 0;
+
+    auto readLength = [&](std::size_t& length) {
+        if (length != 15) return true;
+        std::uint8_t extra;
+        do {
+            if (ip >= srcSize) return false;
+            extra = src[ip++];
+            length += extra;
+        } while (extra == 255);
+        return true;
+    };
+
+    while (ip < srcSize) {
+        std::uint8_t token = src[ip++];
+
+        std::size_t literalLength = token >> 4;
+        if (!readLength(literalLength)) return -1;
+        if (literalLength > srcSize - ip || literalLength > dstCapacity - op) return -1;
+        std::memcpy(dst + op, src + ip, literalLength);
+        ip += literalLength;
+        op += literalLength;
+
+        // The last sequence has literals only
+        if (ip == srcSize) return static_cast<long>(op);
+
+        if (srcSize - ip < 2) return -1;
+        std::size_t offset = src[ip] | (static_cast<std::size_t>(src[ip + 1]) << 8);
+        ip += 2;
+        if (offset == 0 || offset > op) return -1;
+
+        std::size_t matchLength = token & 0x0F;
+        if (!readLength(matchLength)) return -1;
+        matchLength += kMinMatch;
+        if (matchLength > dstCapacity - op) return -1;
+
+        // Byte-wise copy because the match may overlap the bytes it produces
+        for (std::size_t i = 0; i < matchLength; ++i) {
+            dst[op + i] = dst[op - offset + i];
+        }
+        op += matchLength;
+    }
+
+    return -1;
+}
+
+} // namespace motor_characterization
@@ -1,8 +1,33 @@
 #include "main.h"
 #include "system_identification.hpp"
+#include "compressed_log.hpp"
+#include "csv_writer.hpp"
+#include "characterization_history.hpp"
+#include "motor_sampler.hpp"
+#include "feedforward_table.hpp"
+#include "binned_statistics.hpp"
+#include "resampling.hpp"
+#include "running_statistics.hpp"
+#include "sequential_consistency.hpp"
+#include "model_selection.hpp"
+#include "operating_point_analysis.hpp"
+#include "output_error.hpp"
+#include "dead_time.hpp"
+#include "endurance_monitor.hpp"
+#include "fault_detector.hpp"
+#include "friction_model.hpp"
+#include "fixed_point_statistics.hpp"
+#include "frequency_response.hpp"
+#include "group_identification.hpp"
+#include "group_sampler.hpp"
+#include "state_estimator.hpp"
+#include "step_response_fit.hpp"
+#include "telemetry_sampler.hpp"
+#include "thermal_scheduler.hpp"
 #include <vector>
 #include <cmath>
 #include <iostream>
+#include <optional>
 #include <atomic>
 #include <algorithm>
 
@@ -10,54 +35,189 @@ using namespace motor_characterization;
 
 // Motor to characterize (adjust port as needed)
 pros::Motor characterizationMotor(1);
+
+// Coupled motors (e.g. one drivetrain side) for the group test; negative ports are reversed
+pros::MotorGroup characterizationGroup({11, 12, 13});
 static std::atomic<bool> startRequested{false};
 static std::atomic<bool> consistencyTestRequested{false};
+static std::atomic<bool> modeChanged{false};
+
+// Modes selected with the left button and started with the center button
+enum MenuMode {
+    MODE_SINGLE_TEST,
+    MODE_FREQUENCY_TEST,
+    MODE_GROUP_TEST,
+    MODE_ENDURANCE_TEST,
+    MODE_SAVED_RESULTS,
+    MODE_COUNT
+};
+static const char* const modeNames[MODE_COUNT] = {"Single test", "Frequency test", "Group test", "Endurance test",
+                                                  "Saved results"};
+static std::atomic<int> selectedMode{MODE_SINGLE_TEST};
+
+// Name written on the motor under test, used to key its stored history
+static const MotorKey characterizationMotorKey(1, "motor-1");
+static CharacterizationHistory history("/usd");
 
 /**
- * @brief Run complete motor characterization in 20 seconds
+ * @brief Store a result in the SD card history, if a card is inserted
  */
-void runMotorCharacterization() {
-    // Local variables instead of globals
-    double previousVelocity = 0.0;
-    double previousTime = 0.0;
-    
-    // Create system identification object locally
-    SystemIdentification motorSysId;
+void saveToHistory(const FeedforwardConstants& constants, double rSquared, size_t dataPoints,
+                   uint32_t durationMs, HistoryTestType testType, int runCount) {
+    if (!pros::usd::is_installed()) {
+        printf("No SD card: result not saved\n");
+        return;
+    }
+    if (history.append(characterizationMotorKey, constants, rSquared, dataPoints, durationMs,
+                       testType, static_cast<uint8_t>(runCount))) {
+        printf("Saved to history as result #%u\n", history.getRecordCount());
+    } else {
+        printf("Failed to write history to SD card\n");
+    }
+}
+
+// Define voltage test points in millivolts with alternating pattern to test acceleration
+static const std::vector<int> testVoltages = {
+    2000,      // Start at zero
+    6000,   // Jump to high positive
+    2000,      // Back to zero (deceleration)
+    -6000,  // Jump to high negative
+    0,      // Back to zero (deceleration)
+    12000,  // Jump to max positive
+    0,      // Back to zero (deceleration)
+    -12000, // Jump to max negative
+    1000,      // Back to zero (deceleration)
+    3000,   // Medium positive
+    -1000,      // Back to zero
+    -3000   // Medium negative
+};
+
+// Optional compressed capture log on the SD card (for long endurance captures)
+static constexpr bool enableCompressedLog = false;
+static const char* const compressedLogPath = "/usd/capture.mclz";
+static CompressedLogWriter captureLog;
+
+// Channels read on top of what identification needs, only while logging
+static constexpr std::uint32_t loggedTelemetryChannels = TELEMETRY_TORQUE | TELEMETRY_POWER |
+                                                         TELEMETRY_EFFICIENCY | TELEMETRY_TEMPERATURE;
+static constexpr double telemetryBudgetMicros = 10000.0;  // One 100 Hz tick
+
+// Optional binned summary of the capture on the SD card: constant size however
+// long the test, and enough to redo the fit later
+static constexpr bool enableBinnedCapture = false;
+static const char* const binnedCapturePath = "/usd/capture.mcbn";
+
+// Fit against the voltage the motor reports delivering rather than the command,
+// which removes run-to-run variation from battery sag
+static constexpr VoltageSource identificationVoltageSource = VOLTAGE_MEASURED;
+
+// Report block bootstrap intervals and cross-validated R^2 after a single test
+static constexpr bool runResamplingAnalysis = true;
+
+// Compare the V, S+V, V+A and S+V+A models after a single test
+static constexpr bool runModelSelection = true;
+
+// Print local kS/kV per profile segment and velocity band after a single test
+static constexpr bool runOperatingPointAnalysis = true;
+
+// Fit each voltage step's exponential response as a second opinion on the
+// regression (also run whenever R^2 is below stepResponseRSquaredThreshold)
+static constexpr bool runStepResponseFit = false;
+static constexpr double stepResponseRSquaredThreshold = 0.95;
+
+// Refine the constants by simulating the velocity under the recorded voltage,
+// which avoids the bias from noisy velocity and acceleration in the regression
+static constexpr bool runOutputErrorRefinement = true;
+
+// Fit separate forward and reverse friction with a Stribeck term near
+// standstill, where worn motors differ most from the linear model
+static constexpr bool runFrictionModelFit = true;
+
+// Time the batch feedforward evaluators after a successful single test
+static constexpr bool runFeedforwardBenchmark = false;
+
+// Write an interpolated feedforward table to the SD card after a single test,
+// as C++ source that can be compiled into a control program
+static constexpr bool exportFeedforwardTable = false;
+static const char* const feedforwardTablePath = "/usd/ff_table.cpp";
+
+// Kalman-filtered velocity and acceleration (from position, velocity reading
+// and command) with per-sample variances used as regression weights
+static constexpr bool useStateEstimator = true;
+
+// Also accumulate each frame into exact integer statistics on the sampling
+// tick and compare that fit (before dead time alignment) with the main one
+static constexpr bool runFixedPointIngest = true;
+
+// Estimate the delay between voltage and reported motion and fit on aligned data
+static constexpr bool alignDeadTime = true;
+static constexpr int maxDeadTimeSamples = 20;  // 200 ms at 100 Hz
+
+/**
+ * @brief Replace a capture with a copy aligned for the estimated dead time
+ * @param motorSysId Capture to align in place
+ * @param verbose Print the estimate
+ */
+void alignToDeadTime(SystemIdentification& motorSysId, bool verbose) {
+    if (!alignDeadTime) return;
     
-    // Define voltage test points in millivolts with alternating pattern to test acceleration
-    std::vector<int> testVoltages = {
-        2000,      // Start at zero
-        6000,   // Jump to high positive
-        2000,      // Back to zero (deceleration)
-        -6000,  // Jump to high negative
-        0,      // Back to zero (deceleration)
-        12000,  // Jump to max positive
-        0,      // Back to zero (deceleration)
-        -12000, // Jump to max negative
-        1000,      // Back to zero (deceleration)
-        3000,   // Medium positive
-        -1000,      // Back to zero
-        -3000   // Medium negative
-    };
+    DeadTimeEstimate deadTime = DeadTimeEstimator::estimate(motorSysId, maxDeadTimeSamples);
+    if (!deadTime.valid) return;
     
+    if (verbose) {
+        printf("Dead time: %.0f ms (%d samples), R^2 %.4f -> %.4f\n", deadTime.lagSeconds * 1000.0,
+               deadTime.lagSamples, deadTime.rSquaredUnaligned, deadTime.rSquaredAligned);
+    }
+    if (deadTime.lagSamples > 0) {
+        SystemIdentification aligned;
+        DeadTimeEstimator::align(motorSysId, deadTime.lagSamples, aligned);
+        motorSysId = std::move(aligned);
+    }
+}
+
+/**
+ * @brief Optional destinations of a capture besides the identification object
+ */
+struct CaptureOutputs {
+    CompressedLogWriter* log = nullptr;         // Receives every frame
+    TelemetryCost* cost = nullptr;              // Receives the telemetry read cost
+    FixedPointStatistics* fixedPoint = nullptr; // Accumulates every frame on the sampling tick
+    BinnedStatistics* bins = nullptr;           // Accumulates every sample
+};
+
+/**
+ * @brief Drive the test voltage profile and record the motor's response
+ * @param motorSysId Identification object that receives the samples
+ * @param progressLine LCD line used for the progress display
+ * @param progressLabel Label shown before the step counter
+ * @param faults Receives the MotorFault bits seen during the run
+ * @param outputs Where else the capture goes
+ * @return False if the run was aborted by a fault (the motor is stopped)
+ */
+bool collectProfileData(SystemIdentification& motorSysId, int progressLine, const char* progressLabel,
+                        std::uint32_t& faults, const CaptureOutputs& outputs = CaptureOutputs()) {
     // Calculate time per voltage level (20 seconds total)
     int totalVoltages = testVoltages.size();
-    int timePerVoltage = 20000 / totalVoltages; // 20 seconds / number of voltages
-    
-    // LCD: show we're starting (no clears)
-    pros::lcd::print(0, "Starting Characterization");
-    pros::lcd::print(1, "20 seconds total");
+    uint32_t timePerVoltage = 20000 / totalVoltages; // 20 seconds / number of voltages
+    MotorSampler sampler(characterizationMotor);
+    MotorStateEstimator stateEstimator;
+    if (useStateEstimator) {
+        sampler.setStateEstimator(&stateEstimator);
+    }
+    if (outputs.log != nullptr) {
+        sampler.setExtraChannels(loggedTelemetryChannels);
+    }
+    sampler.setFixedPointStatistics(outputs.fixedPoint);
     
     // Collect data for each voltage level
     for (size_t i = 0; i < testVoltages.size(); ++i) {
         int voltage = testVoltages[i];
         
         // Simple LCD display - just show progress
-        pros::lcd::print(0, "Test %d/%d", i + 1, totalVoltages);
+        pros::lcd::print(progressLine, "%s %d/%d", progressLabel, i + 1, totalVoltages);
         
         // Reset previous values for new voltage level
-        previousVelocity = 0.0;
-        previousTime = 0.0;
+        sampler.reset();
         
         // Apply voltage to motor using move_voltage
         characterizationMotor.move_voltage(voltage);
@@ -67,27 +227,94 @@ void runMotorCharacterization() {
         
         while (pros::millis() - startTime < timePerVoltage) {
             double currentTime = (pros::millis() - startTime) / 1000.0;
-            double currentVelocity = characterizationMotor.get_actual_velocity();
             
-            // Direct acceleration calculation without history arrays
-            if (previousTime > 0) {
-                double dt = currentTime - previousTime;
-                if (dt > 0.001) { // Avoid division by zero
-                    double acceleration = (currentVelocity - previousVelocity) / dt;
-                    // Convert voltage from mV to V for data storage
-                    double voltageV = voltage / 1000.0;
-                    motorSysId.addDataPoint(voltageV, currentVelocity, acceleration, currentTime);
-                }
+            DataPoint point(0.0, 0.0, 0.0, 0.0);
+            if (sampler.sample(voltage, currentTime, point)) {
+                motorSysId.addDataPoint(point);
+                if (outputs.log != nullptr) outputs.log->append(sampler.getFrame());
+                if (outputs.bins != nullptr) outputs.bins->add(point);
+            }
+            faults = sampler.getFaultDetector().getLatchedFaults();
+            if (sampler.shouldAbort()) {
+                characterizationMotor.move_voltage(0);
+                if (outputs.cost != nullptr) *outputs.cost = sampler.getTelemetryCost();
+                return false;
             }
             
-            previousVelocity = currentVelocity;
-            previousTime = currentTime;
             pros::delay(10); // 100Hz sampling
         }
         
         // Stop motor
         characterizationMotor.move_voltage(0);
     }
+    if (outputs.cost != nullptr) *outputs.cost = sampler.getTelemetryCost();
+    return true;
+}
+
+/**
+ * @brief Report a run stopped by a fault on the terminal and LCD
+ * @param faults MotorFault bits seen during the run
+ */
+void reportAbort(std::uint32_t faults) {
+    printf("Run aborted: %s\n", FaultDetector::describe(faults));
+    pros::lcd::print(0, "Aborted: %s", FaultDetector::describe(faults));
+    pros::lcd::print(1, "Check the motor and retry");
+}
+
+/**
+ * @brief Run complete motor characterization in 20 seconds
+ */
+void runMotorCharacterization() {
+    // Create system identification object locally
+    SystemIdentification motorSysId;
+    motorSysId.setVoltageSource(identificationVoltageSource);
+    
+    // LCD: show we're starting (no clears)
+    pros::lcd::print(0, "Starting Characterization");
+    pros::lcd::print(1, "20 seconds total");
+    
+    CaptureOutputs outputs;
+    CompressedLogWriter* log = nullptr;
+    if (enableCompressedLog && pros::usd::is_installed() && captureLog.open(compressedLogPath)) {
+        log = &captureLog;
+    }
+    TelemetryCost telemetryCost;
+    FixedPointStatistics fixedPoint(identificationVoltageSource);
+    // The grid is ~144 KB, so it only exists when the capture is binned
+    std::optional<BinnedStatistics> bins;
+    if (enableBinnedCapture) bins.emplace(BinningOptions(), identificationVoltageSource);
+    outputs.log = log;
+    outputs.cost = &telemetryCost;
+    outputs.fixedPoint = runFixedPointIngest ? &fixedPoint : nullptr;
+    outputs.bins = bins ? &*bins : nullptr;
+    
+    std::uint32_t faults = FAULT_NONE;
+    bool completed = collectProfileData(motorSysId, 0, "Test", faults, outputs);
+    
+    printf("Telemetry read: %.0f us/tick mean, %u us max, %.0f us/channel (%d channels fit in %.0f ms)\n",
+           telemetryCost.meanTickMicros, static_cast<unsigned>(telemetryCost.maxTickMicros),
+           telemetryCost.meanChannelMicros, telemetryCost.channelsWithin(telemetryBudgetMicros),
+           telemetryBudgetMicros / 1000.0);
+    if (log != nullptr) {
+        bool logOk = log->close();
+        printf("Compressed log %s: %zu frames, %zu -> %zu bytes%s\n", compressedLogPath,
+               log->getSampleCount(), log->getSampleCount() * sizeof(TelemetryFrame),
+               log->getWrittenBytes(), logOk ? "" : " (write error)");
+    }
+    
+    if (bins && pros::usd::is_installed()) {
+        bool binsOk = bins->save(binnedCapturePath);
+        printf("Binned capture %s: %u samples in %d cells%s\n", binnedCapturePath, bins->getSampleCount(),
+               bins->getOccupiedCells(), binsOk ? "" : " (write error)");
+    }
+    
+    if (!completed) {
+        reportAbort(faults);
+        return;
+    }
+    if (faults != FAULT_NONE) {
+        printf("Samples skipped for: %s\n", FaultDetector::describe(faults));
+    }
     
     // Perform system identification
     pros::lcd::print(0, "Analyzing Data...");
@@ -99,6 +326,8 @@ void runMotorCharacterization() {
         double minVoltage = dataPoints[0].voltage, maxVoltage = dataPoints[0].voltage;
         double minVelocity = dataPoints[0].velocity, maxVelocity = dataPoints[0].velocity;
         double minAccel = dataPoints[0].acceleration, maxAccel = dataPoints[0].acceleration;
+        double minBattery = dataPoints[0].batteryVoltage, maxBattery = dataPoints[0].batteryVoltage;
+        size_t saturatedCount = 0;
         
         for (const auto& point : dataPoints) {
             minVoltage = std::min(minVoltage, point.voltage);
@@ -107,15 +336,22 @@ void runMotorCharacterization() {
             maxVelocity = std::max(maxVelocity, point.velocity);
             minAccel = std::min(minAccel, point.acceleration);
             maxAccel = std::max(maxAccel, point.acceleration);
+            minBattery = std::min(minBattery, point.batteryVoltage);
+            maxBattery = std::max(maxBattery, point.batteryVoltage);
+            if (point.saturated) saturatedCount++;
         }
         
         printf("\nData Statistics:\n");
         printf("Voltage range: %.2f to %.2f V\n", minVoltage, maxVoltage);
         printf("Velocity range: %.1f to %.1f RPM\n", minVelocity, maxVelocity);
         printf("Acceleration range: %.1f to %.1f RPM/s\n", minAccel, maxAccel);
+        printf("Battery range: %.2f to %.2f V\n", minBattery, maxBattery);
+        printf("Saturated samples: %zu\n", saturatedCount);
         printf("Data points: %zu\n", dataPoints.size());
     }
     
+    alignToDeadTime(motorSysId, true);
+    
     bool success = motorSysId.identify(true, true); // Include static friction and acceleration
 
     if (success) {
@@ -123,14 +359,104 @@ void runMotorCharacterization() {
         
         // Print results to terminal
         printf("\n=== MOTOR CHARACTERIZATION RESULTS ===\n");
-        printf("Data points collected: %zu\n", motorSysId.getDataPointCount());
+        printf("Data points collected: %zu (%zu used)\n", motorSysId.getDataPointCount(),
+               motorSysId.getUsableDataPointCount());
+        printf("Fitted against %s voltage\n",
+               motorSysId.getVoltageSource() == VOLTAGE_MEASURED ? "measured" : "commanded");
         printf("R-squared (fit quality): %.4f\n", motorSysId.getRSquared());
-        printf("\nFeedforward Constants:\n");
-        printf("kS (Static Friction): %.4f V\n", constants.kS);
-        printf("kV (Velocity): %.4f V/RPM\n", constants.kV);
-        printf("kA (Acceleration): %.6f V/(RPM/s)\n", constants.kA);
+        const ParameterUncertainty& uncertainty = motorSysId.getUncertainty();
+        printf("\nFeedforward Constants (%.0f%% confidence):\n", uncertainty.confidenceLevel * 100.0);
+        printf("kS (Static Friction): %.4f ± %.4f V\n", constants.kS, uncertainty.confidenceHalfWidth(0));
+        printf("kV (Velocity): %.4f ± %.4f V/RPM\n", constants.kV, uncertainty.confidenceHalfWidth(1));
+        printf("kA (Acceleration): %.6f ± %.6f V/(RPM/s)\n", constants.kA, uncertainty.confidenceHalfWidth(2));
+        printf("Residual std dev: %.3f V (lag-1 correlation %.2f)\n", uncertainty.residualStdDev,
+               uncertainty.residualAutocorrelation);
         printf("\nModel: V = kS*sign(v) + kV*v + kA*a\n");
         
+        if (runFixedPointIngest) {
+            StatisticsFit fixedFit = fixedPoint.solve(TERM_ALL);
+            if (fixedFit.valid) {
+                Eigen::Vector3d bound = fixedPoint.quantizationBound(fixedFit, TERM_ALL);
+                printf("\nInteger ingest (%u samples, %u rejected, unaligned):\n", fixedPoint.getCount(),
+                       fixedPoint.getRejectedCount());
+                printf("  kS: %.4f V, kV: %.4f V/RPM, kA: %.6f V/(RPM/s)\n", fixedFit.coefficients(0),
+                       fixedFit.coefficients(1), fixedFit.coefficients(2));
+                printf("  Rounding bound: %.1e V, %.1e V/RPM, %.1e V/(RPM/s)\n", bound(0), bound(1), bound(2));
+            }
+        }
+        
+        if (bins) {
+            StatisticsFit binFit = bins->solve(TERM_ALL);
+            if (binFit.valid) {
+                printf("\nBinned fit (%d cells, unaligned): kS %.4f V, kV %.4f V/RPM, kA %.6f V/(RPM/s), R^2 %.4f\n",
+                       bins->getOccupiedCells(), binFit.coefficients(0), binFit.coefficients(1),
+                       binFit.coefficients(2), binFit.rSquared);
+            }
+        }
+        
+        if (runResamplingAnalysis) {
+            // Half-second blocks keep correlated residuals together
+            BlockResampler resampler(motorSysId, 50);
+            CrossValidationResult crossValidation = resampler.crossValidate(5);
+            BootstrapResult bootstrap = resampler.bootstrap(1000, 0.95);
+            if (crossValidation.valid) {
+                printf("\n5-fold R-squared: %.4f (RMSE %.3f V)\n", crossValidation.outOfSampleRSquared,
+                       crossValidation.rootMeanSquareError);
+            }
+            if (bootstrap.replicates > 0) {
+                printf("Block bootstrap (%d replicates, %.0f%%):\n", bootstrap.replicates,
+                       bootstrap.confidenceLevel * 100.0);
+                printf("  kS: %.4f to %.4f V\n", bootstrap.lower(0), bootstrap.upper(0));
+                printf("  kV: %.4f to %.4f V/RPM\n", bootstrap.lower(1), bootstrap.upper(1));
+                printf("  kA: %.6f to %.6f V/(RPM/s)\n", bootstrap.lower(2), bootstrap.upper(2));
+            }
+        }
+        
+        if (runModelSelection) {
+            // Rank with the correlation-corrected sample count so extra terms
+            // are not favoured just because samples are taken quickly
+            std::vector<ModelCandidate> models =
+                selectModels(motorSysId.getSufficientStatistics(), uncertainty.effectiveSamples);
+            printModelTable(models);
+            if (!models.empty() && models.front().fit.valid && !(models.front().terms & TERM_ACCELERATION)) {
+                printf("kA is not supported by this capture (best model: %s)\n", models.front().name);
+            }
+        }
+        
+        if (runOperatingPointAnalysis) {
+            OperatingPointAnalysis operatingPoints(motorSysId);
+            operatingPoints.printTables();
+        }
+        
+        if (runStepResponseFit || motorSysId.getRSquared() < stepResponseRSquaredThreshold) {
+            StepResponseFit stepResponse(motorSysId);
+            stepResponse.printTable(constants);
+            if (stepResponse.isValid() && motorSysId.getRSquared() < stepResponseRSquaredThreshold) {
+                printf("R^2 is low: prefer the step response constants if they differ by many sigma\n");
+            }
+        }
+        
+        if (runOutputErrorRefinement) {
+            OutputErrorFit refined = OutputErrorRefinement::refine(motorSysId, constants);
+            if (refined.valid) {
+                printf("\nOutput-error refinement (%d iterations, velocity RMS %.2f -> %.2f RPM):\n",
+                       refined.iterations, refined.initialRms, refined.finalRms);
+                printf("  kS: %.4f ± %.4f V\n", refined.constants.kS, refined.standardError(0));
+                printf("  kV: %.4f ± %.4f V/RPM\n", refined.constants.kV, refined.standardError(1));
+                printf("  kA: %.6f ± %.6f V/(RPM/s)\n", refined.constants.kA, refined.standardError(2));
+            } else {
+                printf("\nOutput-error refinement: the regression result cannot be simulated\n");
+            }
+        }
+        
+        if (runFrictionModelFit) {
+            uint64_t fitStart = pros::micros();
+            FrictionModelFit friction = fitFrictionModel(motorSysId, constants);
+            uint64_t fitMicros = pros::micros() - fitStart;
+            printFrictionModel(friction);
+            printf("  Fit time: %.1f ms\n", fitMicros / 1000.0);
+        }
+        
         // Debug: Check for negative kS and explain possible causes
         if (constants.kS < 0) {
             printf("\n⚠️  WARNING: Negative kS detected!\n");
@@ -155,14 +481,30 @@ void runMotorCharacterization() {
         printf("\nCalculated Metrics:\n");
         printf("Max velocity (at 12V): %.1f RPM\n", maxVelocity);
         printf("Voltage for 100 RPM: %.2f V\n", voltage100);
+        saveToHistory(constants, motorSysId.getRSquared(), motorSysId.getDataPointCount(),
+                      20000, HISTORY_SINGLE_TEST, 1);
         printf("=====================================\n\n");
         
+        if (runFeedforwardBenchmark) {
+            benchmarkFeedforward(constants);
+        }
+        
+        if (exportFeedforwardTable && pros::usd::is_installed()) {
+            FeedforwardTable table;
+            if (table.generate(constants) && table.exportSource(feedforwardTablePath, "motorFeedforward")) {
+                printf("Feedforward table %s: %zu bytes, max error %.2f mV\n", feedforwardTablePath,
+                       table.getSizeBytes(), table.getMaxError() * 1000.0);
+            } else {
+                printf("Failed to export feedforward table\n");
+            }
+        }
+        
         // Also show on LCD
-        pros::lcd::print(0, "kS: %.2f kV: %.3f", constants.kS, constants.kV);
-        pros::lcd::print(1, "kA: %.4f R^2: %.3f", constants.kA, motorSysId.getRSquared());
-        pros::lcd::print(2, "Max Vel: %.0f RPM", maxVelocity);
-        pros::lcd::print(3, "100RPM: %.1fV", voltage100);
-        pros::lcd::print(4, "Points: %zu", motorSysId.getDataPointCount());
+        pros::lcd::print(0, "kS: %.3f±%.3f", constants.kS, uncertainty.confidenceHalfWidth(0));
+        pros::lcd::print(1, "kV: %.4f±%.4f", constants.kV, uncertainty.confidenceHalfWidth(1));
+        pros::lcd::print(2, "kA: %.5f±%.5f", constants.kA, uncertainty.confidenceHalfWidth(2));
+        pros::lcd::print(3, "R^2: %.3f Points: %zu", motorSysId.getRSquared(), motorSysId.getDataPointCount());
+        pros::lcd::print(4, "Max Vel: %.0f RPM 100RPM: %.1fV", maxVelocity, voltage100);
         pros::lcd::print(5, "Press center to retest");
     } else {
         printf("\n=== CHARACTERIZATION FAILED ===\n");
@@ -176,132 +518,451 @@ void runMotorCharacterization() {
     }
 }
 
+// Frequency test: multisine around a forward operating point, 20 s record
+static constexpr double frequencyTestOffset = 7.0;        // V, keeps the motor turning one way
+static constexpr double frequencyTestPeak = 4.5;          // V deviation from the offset
+static constexpr double frequencyTestSampleRate = 100.0;  // Hz
+static constexpr size_t frequencyTestSamples = 2000;      // One period of the multisine
+static constexpr size_t frequencyTestLeadIn = 200;        // Samples to settle before measuring
+
 /**
- * @brief Run 10 consecutive tests and analyze consistency
+ * @brief Measure the voltage -> velocity frequency response and fit kS, kV, kA to it
  */
-void runConsistencyTest() {
-    std::vector<FeedforwardConstants> results;
-    std::vector<double> rSquaredValues;
+void runFrequencyResponseTest() {
+    const double recordSeconds = frequencyTestSamples / frequencyTestSampleRate;
+    std::vector<double> frequencies = FrequencyResponseEstimator::logFrequencies(0.2, 12.0, 12, recordSeconds);
+    ExcitationSignal excitation = ExcitationSignal::multisine(frequencies, frequencyTestOffset, frequencyTestPeak,
+                                                              frequencyTestSampleRate, frequencyTestSamples);
+    FrequencyResponseEstimator estimator(frequencies, frequencyTestSampleRate);
+    MotorSampler sampler(characterizationMotor);
     
-    printf("\n=== STARTING CONSISTENCY TEST (5 runs) ===\n");
-    pros::lcd::print(0, "Consistency Test");
-    pros::lcd::print(1, "5 consecutive tests");
+    pros::lcd::print(0, "Frequency Test");
+    pros::lcd::print(1, "%zu tones, %.0f seconds", frequencies.size(), recordSeconds);
     
-    for (int test = 1; test <= 5; ++test) {
-        printf("\n--- Test %d/5 ---\n", test);
-        pros::lcd::print(0, "Test %d/5", test);
+    // The signal is periodic, so the lead-in plays the end of the period and
+    // measurement starts in steady state at sample 0. delay_until keeps the
+    // samples evenly spaced, which the Goertzel bins rely on.
+    const uint32_t periodMs = static_cast<uint32_t>(1000.0 / frequencyTestSampleRate);
+    uint32_t now = pros::millis();
+    size_t saturatedCount = 0;
+    size_t faultedCount = 0;
+    for (size_t tick = 0; tick < frequencyTestLeadIn + frequencyTestSamples; ++tick) {
+        size_t index = (tick + frequencyTestSamples - frequencyTestLeadIn) % frequencyTestSamples;
+        int command = static_cast<int>(std::lround(excitation.voltageAt(index) * 1000.0));
+        characterizationMotor.move_voltage(command);
+        pros::Task::delay_until(&now, periodMs);
         
-        // Create fresh system identification object for each test
-        SystemIdentification motorSysId;
+        DataPoint point(0.0, 0.0, 0.0, 0.0);
+        bool sampled = sampler.sample(command, (tick + 1) / frequencyTestSampleRate, point);
+        if (sampler.shouldAbort()) {
+            characterizationMotor.move_voltage(0);
+            reportAbort(sampler.getFaultDetector().getLatchedFaults());
+            return;
+        }
+        if (tick < frequencyTestLeadIn || !sampled) continue;
+        
+        // The bins need evenly spaced samples, so faulted ones are kept and counted
+        estimator.add(identificationVoltageSource == VOLTAGE_MEASURED ? point.appliedVoltage : point.voltage,
+                      point.velocity);
+        if (point.saturated) saturatedCount++;
+        if (point.faults != FAULT_NONE) faultedCount++;
+        if (index % 200 == 0) {
+            pros::lcd::print(2, "Measuring %zu%%", index * 100 / frequencyTestSamples);
+        }
+    }
+    characterizationMotor.move_voltage(0);
+    
+    FrequencyResponseFit fit = estimator.fit(0.1);
+    
+    printf("\n=== FREQUENCY RESPONSE ===\n");
+    printf("Samples: %zu (%zu saturated, %zu faulted)\n", estimator.getSampleCount(), saturatedCount,
+           faultedCount);
+    printf("Freq (Hz)  Gain (RPM/V)  Phase (deg)\n");
+    for (const auto& point : estimator.getResponse()) {
+        printf("%8.2f  %12.2f  %11.1f\n", point.frequency, point.magnitude, point.phaseDegrees);
+    }
+    
+    if (!fit.valid) {
+        printf("Fit failed: no usable response\n");
+        printf("=====================================\n\n");
+        pros::lcd::print(0, "Frequency test failed");
+        pros::lcd::print(1, "Check terminal for details");
+        return;
+    }
+    
+    printf("\nkS: %.4f V\n", fit.kS);
+    printf("kV: %.4f V/RPM\n", fit.kV);
+    printf("kA: %.6f V/(RPM/s)\n", fit.kA);
+    printf("Dead time: %.0f ms\n", fit.deadTime * 1000.0);
+    printf("Relative fit error: %.1f%%\n", fit.relativeError * 100.0);
+    saveToHistory(FeedforwardConstants(fit.kS, fit.kV, fit.kA), 1.0 - fit.relativeError * fit.relativeError,
+                  estimator.getSampleCount(), static_cast<uint32_t>(recordSeconds * 1000.0),
+                  HISTORY_FREQUENCY_TEST, 1);
+    printf("=====================================\n\n");
+    
+    pros::lcd::print(0, "kS: %.2f kV: %.4f", fit.kS, fit.kV);
+    pros::lcd::print(1, "kA: %.5f", fit.kA);
+    pros::lcd::print(2, "Dead time: %.0f ms", fit.deadTime * 1000.0);
+    pros::lcd::print(3, "Fit error: %.1f%%", fit.relativeError * 100.0);
+    pros::lcd::print(4, "Press center to retest");
+}
+
+/**
+ * @brief Characterize the motor group as one mechanism and find the member dragging it
+ */
+void runGroupCharacterization() {
+    GroupSampler sampler(characterizationGroup);
+    GroupIdentification groupId(sampler.getMemberCount());
+    groupId.setVoltageSource(identificationVoltageSource);
+    const std::vector<std::int8_t> ports = characterizationGroup.get_port_all();
+    const int portCount = static_cast<int>(ports.size());
+    
+    pros::lcd::print(0, "Group Test (%d motors)", sampler.getMemberCount());
+    pros::lcd::print(1, "20 seconds total");
+    
+    // Same profile as the single test, with one command for the whole group
+    int totalVoltages = testVoltages.size();
+    uint32_t timePerVoltage = 20000 / totalVoltages;
+    for (size_t i = 0; i < testVoltages.size(); ++i) {
+        int voltage = testVoltages[i];
+        pros::lcd::print(2, "Voltage %d/%d", i + 1, totalVoltages);
+        sampler.reset();
+        characterizationGroup.move_voltage(voltage);
         
-        // Define voltage test points (same as single test)
-        std::vector<int> testVoltages = {
-            2000,      // Start at zero
-        6000,   // Jump to high positive
-        2000,      // Back to zero (deceleration)
-        -6000,  // Jump to high negative
-        0,      // Back to zero (deceleration)
-        12000,  // Jump to max positive
-        0,      // Back to zero (deceleration)
-        -12000, // Jump to max negative
-        1000,      // Back to zero (deceleration)
-        3000,   // Medium positive
-        -1000,      // Back to zero
-        -3000   // Medium negative
-        };
-        
-        int totalVoltages = testVoltages.size();
-        int timePerVoltage = 20000 / totalVoltages;
-        
-        // Collect data for each voltage level
-        for (size_t i = 0; i < testVoltages.size(); ++i) {
+        uint32_t startTime = pros::millis();
+        while (pros::millis() - startTime < timePerVoltage) {
+            double currentTime = (pros::millis() - startTime) / 1000.0;
+            GroupSample sample;
+            if (sampler.sample(voltage, currentTime, sample)) {
+                groupId.add(sample);
+            }
+            if (sampler.shouldAbort()) {
+                characterizationGroup.move_voltage(0);
+                reportAbort(sampler.getLatchedFaults());
+                return;
+            }
+            pros::delay(10);
+        }
+        characterizationGroup.move_voltage(0);
+    }
+    
+    if (!groupId.identify()) {
+        printf("Group identification failed (%u samples)\n", groupId.getSampleCount());
+        pros::lcd::print(0, "Group test failed");
+        pros::lcd::print(1, "Check terminal for details");
+        return;
+    }
+    
+    const StatisticsFit& combined = groupId.getCombinedFit();
+    printf("\n=== GROUP CHARACTERIZATION ===\n");
+    printf("Samples: %u\n", groupId.getSampleCount());
+    printf("Combined: kS=%.4f V, kV=%.5f V/RPM, kA=%.6f V/(RPM/s), R^2=%.4f\n", combined.coefficients(0),
+           combined.coefficients(1), combined.coefficients(2), combined.rSquared);
+    printf("\nPort  Share   Speed    kS       kV        Current  Drag\n");
+    for (int i = 0; i < groupId.getMemberCount(); ++i) {
+        const GroupMemberResult& member = groupId.getMember(i);
+        printf("%4d  %5.1f%%  %5.2fx  %7.4f  %8.5f  %6.2f A  %4.0f%%%s\n", i < portCount ? ports[i] : 0,
+               member.share * 100.0, member.speedRatio, member.fit.coefficients(0), member.fit.coefficients(1),
+               member.meanCurrent, member.dragScore * 100.0, i == groupId.getDraggingMember() ? "  <-- dragging" : "");
+    }
+    printf("=====================================\n\n");
+    
+    pros::lcd::print(0, "kS: %.3f kV: %.4f", combined.coefficients(0), combined.coefficients(1));
+    pros::lcd::print(1, "kA: %.5f R^2: %.3f", combined.coefficients(2), combined.rSquared);
+    int dragging = groupId.getDraggingMember();
+    if (dragging >= 0) {
+        pros::lcd::print(2, "Dragging: port %d (+%.0f%%)", dragging < portCount ? ports[dragging] : 0,
+                         groupId.getMember(dragging).dragScore * 100.0);
+    } else {
+        pros::lcd::print(2, "All motors pulling evenly");
+    }
+    pros::lcd::print(3, "Press center to retest");
+}
+
+// Endurance test: the profile repeats with one identification window per pass
+static constexpr double enduranceMaxHours = 4.0;
+static constexpr uint32_t enduranceTickMs = 10;
+static const char* const enduranceLogPath = "/usd/endurance.csv";
+
+/**
+ * @brief Cycle the test profile for hours, identify every pass and stop at the wear threshold
+ *
+ * Everything the loop touches is created before it starts (sampler,
+ * estimator, window statistics, CSV buffer), so nothing is allocated
+ * while it runs. Ticks are paced with delay_until; the only file I/O is one
+ * CSV row per window, written between passes.
+ */
+void runEnduranceTest() {
+    EnduranceMonitor monitor(EnduranceOptions(), identificationVoltageSource);
+    MotorSampler sampler(characterizationMotor);
+    MotorStateEstimator stateEstimator;
+    if (useStateEstimator) {
+        sampler.setStateEstimator(&stateEstimator);
+    }
+    sampler.setExtraChannels(TELEMETRY_TEMPERATURE);
+    
+    std::FILE* logFile = pros::usd::is_installed() ? std::fopen(enduranceLogPath, "w") : nullptr;
+    CsvWriter csv(logFile, 1024);
+    const char* const columns[] = {"window", "time_s", "kS", "kV", "kA", "r_squared", "samples",
+                                   "temperature_c", "rms_current_a", "smoothed_kS", "smoothed_kV",
+                                   "drift_kS", "drift_kV", "state", "late_ticks"};
+    for (const char* column : columns) csv.writeText(column);
+    csv.endRow();
+    csv.flush();
+    
+    pros::lcd::print(0, "Endurance Test");
+    pros::lcd::print(1, "Up to %.1f hours", enduranceMaxHours);
+    pros::lcd::print(2, "Press center to stop");
+    printf("\n=== ENDURANCE TEST ===\n");
+    printf("Window  Time (min)  kS (V)  kV (V/RPM)  kA (V/(RPM/s))  Temp (C)  Irms (A)  State\n");
+    
+    const uint32_t stepTicks = 20000 / testVoltages.size() / enduranceTickMs;
+    const uint32_t testStart = pros::millis();
+    uint32_t lateTicks = 0;
+    uint32_t maxLateMs = 0;
+    EnduranceWindow last;
+    bool haveWindow = false;
+    const char* stopReason = "time limit";
+    startRequested = false;
+    
+    bool running = true;
+    while (running) {
+        // One window is one pass through the profile
+        for (size_t i = 0; i < testVoltages.size() && running; ++i) {
             int voltage = testVoltages[i];
-            pros::lcd::print(1, "Voltage %d/%d", i + 1, totalVoltages);
-            
-            double previousVelocity = 0.0;
-            double previousTime = 0.0;
-            
+            sampler.reset();
             characterizationMotor.move_voltage(voltage);
-            
-            uint32_t startTime = pros::millis();
-            while (pros::millis() - startTime < timePerVoltage) {
-                double currentTime = (pros::millis() - startTime) / 1000.0;
-                double currentVelocity = characterizationMotor.get_actual_velocity();
+            uint32_t stepStart = pros::millis();
+            uint32_t now = stepStart;
+            for (uint32_t tick = 0; tick < stepTicks; ++tick) {
+                pros::Task::delay_until(&now, enduranceTickMs);
+                uint32_t lateMs = pros::millis() - now;
+                if (lateMs > 1) lateTicks++;
+                maxLateMs = std::max(maxLateMs, lateMs);
                 
-                if (previousTime > 0) {
-                    double dt = currentTime - previousTime;
-                    if (dt > 0.001) {
-                        double acceleration = (currentVelocity - previousVelocity) / dt;
-                        double voltageV = voltage / 1000.0;
-                        motorSysId.addDataPoint(voltageV, currentVelocity, acceleration, currentTime);
-                    }
+                DataPoint point(0.0, 0.0, 0.0, 0.0);
+                if (sampler.sample(voltage, (now - stepStart) / 1000.0, point)) {
+                    monitor.add(sampler.getFrame());
+                }
+                if (sampler.shouldAbort()) {
+                    stopReason = FaultDetector::describe(sampler.getFaultDetector().getLatchedFaults());
+                    running = false;
+                    break;
+                }
+                if (startRequested.exchange(false)) {
+                    stopReason = "stopped by user";
+                    running = false;
+                    break;
                 }
-                
-                previousVelocity = currentVelocity;
-                previousTime = currentTime;
-                pros::delay(10);
             }
+        }
+        if (!running) break;  // The partial pass is not identified
+        
+        double elapsed = (pros::millis() - testStart) / 1000.0;
+        EnduranceWindow window;
+        if (monitor.closeWindow(elapsed, window)) {
+            csv.writeField(static_cast<std::int64_t>(window.index));
+            csv.writeField(window.endTime, 1);
+            csv.writeField(window.kS, 5);
+            csv.writeField(window.kV, 7);
+            csv.writeField(window.kA, 8);
+            csv.writeField(window.rSquared, 5);
+            csv.writeField(static_cast<std::int64_t>(window.samples));
+            csv.writeField(window.meanTemperature, 1);
+            csv.writeField(window.rmsCurrent, 3);
+            csv.writeField(window.smoothedKS, 5);
+            csv.writeField(window.smoothedKV, 7);
+            csv.writeField(window.driftKS, 2);
+            csv.writeField(window.driftKV, 2);
+            csv.writeText(EnduranceMonitor::describe(window.state));
+            csv.writeField(static_cast<std::int64_t>(lateTicks));
+            csv.endRow();
+            csv.flush();
             
-            characterizationMotor.move_voltage(0);
+            printf("%6u  %10.1f  %6.3f  %10.5f  %14.6f  %8.1f  %8.2f  %s\n", window.index, elapsed / 60.0,
+                   window.kS, window.kV, window.kA, window.meanTemperature, window.rmsCurrent,
+                   EnduranceMonitor::describe(window.state));
+            pros::lcd::print(3, "%.0f min, window %u", elapsed / 60.0, window.index);
+            pros::lcd::print(4, "kS %.3f kV %.5f", window.kS, window.kV);
+            pros::lcd::print(5, "%.0f C, %.2f A rms", window.meanTemperature, window.rmsCurrent);
+            pros::lcd::print(6, "State: %s", EnduranceMonitor::describe(window.state));
+            last = window;
+            haveWindow = true;
         }
         
-        // Perform identification
+        if (monitor.isWorn()) {
+            stopReason = "wear threshold reached";
+            running = false;
+        } else if (elapsed >= enduranceMaxHours * 3600.0) {
+            running = false;
+        }
+    }
+    characterizationMotor.move_voltage(0);
+    if (logFile != nullptr) {
+        std::fclose(logFile);
+    }
+    
+    const uint32_t durationMs = pros::millis() - testStart;
+    TelemetryCost cost = sampler.getTelemetryCost();
+    printf("\nStopped after %.1f min: %s\n", durationMs / 60000.0, stopReason);
+    printf("Windows: %u, late ticks: %u (worst %u ms), telemetry %.0f us/tick\n", monitor.getWindowCount(),
+           lateTicks, maxLateMs, cost.meanTickMicros);
+    if (monitor.getState() >= ENDURANCE_MONITORING) {
+        printf("Baseline: kS %.4f V, kV %.6f V/RPM\n", monitor.getBaseline(0), monitor.getBaseline(1));
+    }
+    if (haveWindow) {
+        // Smoothed values are steadier than any single window once they exist
+        bool smoothedReady = last.state >= ENDURANCE_MONITORING;
+        FeedforwardConstants constants(smoothedReady ? last.smoothedKS : last.kS,
+                                       smoothedReady ? last.smoothedKV : last.kV, last.kA);
+        printf("Final: kS %.4f V, kV %.6f V/RPM, kA %.6f V/(RPM/s)\n", constants.kS, constants.kV, constants.kA);
+        saveToHistory(constants, last.rSquared, last.samples, durationMs, HISTORY_ENDURANCE_TEST,
+                      static_cast<int>(std::min<std::uint32_t>(monitor.getWindowCount(), 255)));
+    }
+    printf("=====================================\n\n");
+    
+    pros::lcd::print(0, "Endurance: %s", stopReason);
+    pros::lcd::print(1, "%.0f min, %u windows", durationMs / 60000.0, monitor.getWindowCount());
+    pros::lcd::print(2, "Log: %s", logFile != nullptr ? enduranceLogPath : "no SD card");
+}
+
+// Consistency runs start within this much of the first run's start temperature
+static constexpr double thermalTolerance = 2.5;  // C
+static constexpr double thermalMaxWait = 300.0;  // s, start anyway after this long
+
+// Repeated runs stop once the mean of every constant is pinned down to these
+// relative 95% half-widths (kS, kV, kA), or once the spread is clearly too large
+static constexpr int consistencyMinRuns = 2;
+static constexpr int consistencyMaxRuns = 8;
+static constexpr double consistencyTargetHalfWidth[3] = {0.10, 0.03, 0.25};
+
+/**
+ * @brief Wait until the motor is predicted to be cool enough for the next run
+ * @param scheduler Scheduler holding the thermal model and start band
+ */
+void waitForThermalBand(ThermalScheduler& scheduler) {
+    while (true) {
+        double now = pros::millis() / 1000.0;
+        double temperature = characterizationMotor.get_temperature();
+        scheduler.observeRest(now, temperature);
+        if (scheduler.readyToStart(now, temperature)) return;
+        
+        double predicted = scheduler.predictTemperature(now, temperature);
+        double remaining = scheduler.getModel().timeToCool(predicted, scheduler.getStartLimit());
+        if (std::isfinite(remaining)) {
+            pros::lcd::print(1, "Cooling %.1fC -> %.1fC (%.0fs)", predicted, scheduler.getStartLimit(), remaining);
+        } else {
+            pros::lcd::print(1, "Cooling %.1fC -> %.1fC", predicted, scheduler.getStartLimit());
+        }
+        pros::delay(1000);
+    }
+}
+
+/**
+ * @brief Repeat tests until the constants are consistent or clearly not, and analyze them
+ */
+void runConsistencyTest() {
+    ConsistencyOptions options;
+    options.minRuns = consistencyMinRuns;
+    options.maxRuns = consistencyMaxRuns;
+    for (int term = 0; term < 3; ++term) options.targetHalfWidth[term] = consistencyTargetHalfWidth[term];
+    SequentialConsistency sequence(options);
+    RunningStatistics rSquaredValues;
+    size_t totalDataPoints = 0;
+    ThermalScheduler thermal(thermalTolerance, thermalMaxWait);
+    uint32_t seriesStart = pros::millis();
+    
+    printf("\n=== STARTING CONSISTENCY TEST (%d to %d runs) ===\n", consistencyMinRuns, consistencyMaxRuns);
+    pros::lcd::print(0, "Consistency Test");
+    pros::lcd::print(1, "Up to %d tests", consistencyMaxRuns);
+    
+    while (sequence.getDecision() == CONSISTENCY_CONTINUE) {
+        int test = sequence.getRunCount() + 1;
+        printf("\n--- Test %d (max %d) ---\n", test, consistencyMaxRuns);
+        pros::lcd::print(0, "Test %d (max %d)", test, consistencyMaxRuns);
+        
+        // Create fresh system identification object for each test
+        SystemIdentification motorSysId;
+        motorSysId.setVoltageSource(identificationVoltageSource);
+        
+        // Let the motor cool to the first run's temperature so kV is comparable
+        waitForThermalBand(thermal);
+        double startTime = pros::millis() / 1000.0;
+        double startTemperature = characterizationMotor.get_temperature();
+        
+        // Run the same voltage profile as the single test
+        std::uint32_t faults = FAULT_NONE;
+        if (!collectProfileData(motorSysId, 1, "Voltage", faults)) {
+            // A faulted motor would only get worse with more runs
+            reportAbort(faults);
+            return;
+        }
+        
+        double endTime = pros::millis() / 1000.0;
+        double endTemperature = characterizationMotor.get_temperature();
+        double currentSquared = 0.0;
+        for (const auto& point : motorSysId.getDataPoints()) currentSquared += point.current * point.current;
+        if (motorSysId.getDataPointCount() > 0) currentSquared /= motorSysId.getDataPointCount();
+        thermal.recordRun(startTime, startTemperature, endTime, endTemperature, currentSquared);
+        printf("Temperature: %.0f C -> %.0f C\n", startTemperature, endTemperature);
+        
+        // Perform identification on dead-time aligned data
+        alignToDeadTime(motorSysId, false);
         bool success = motorSysId.identify(true, true);
         
         if (success) {
             FeedforwardConstants constants = motorSysId.getConstants();
-            results.push_back(constants);
-            rSquaredValues.push_back(motorSysId.getRSquared());
+            sequence.addRun(constants);
+            rSquaredValues.add(motorSysId.getRSquared());
+            totalDataPoints += motorSysId.getDataPointCount();
             
             printf("Test %d: kS=%.3f, kV=%.4f, kA=%.5f, R²=%.3f\n", 
                    test, constants.kS, constants.kV, constants.kA, motorSysId.getRSquared());
         } else {
+            sequence.addFailedRun();
             printf("Test %d: FAILED\n", test);
         }
-        
-        // Brief pause between tests
-        pros::delay(500);
+        if (sequence.getSuccessfulRuns() >= 2) {
+            printf("Mean within ±%.1f%% / ±%.1f%% / ±%.1f%% (kS/kV/kA, 95%%)\n",
+                   sequence.relativeHalfWidth(0) * 100, sequence.relativeHalfWidth(1) * 100,
+                   sequence.relativeHalfWidth(2) * 100);
+            pros::lcd::print(1, "kV mean ±%.1f%% after %d", sequence.relativeHalfWidth(1) * 100,
+                             sequence.getSuccessfulRuns());
+        }
+    }
+    
+    const FeedforwardStatistics& results = sequence.getStatistics();
+    const int runCount = sequence.getRunCount();
+    printf("\nStopped after %d runs: %s\n", runCount, SequentialConsistency::describe(sequence.getDecision()));
+    
+    const ThermalModel& thermalModel = thermal.getModel();
+    printf("\nSeries time: %.0f s\n", (pros::millis() - seriesStart) / 1000.0);
+    if (thermalModel.valid) {
+        printf("Thermal model: ambient %.1f C, time constant %.0f s\n", thermalModel.ambient,
+               thermalModel.timeConstant);
     }
     
     // Analyze consistency
-    if (results.size() >= 3) {
+    const int successfulTests = sequence.getSuccessfulRuns();
+    if (successfulTests >= 2) {
         printf("\n=== CONSISTENCY ANALYSIS ===\n");
-        printf("Successful tests: %zu/5\n", results.size());
-        
-        // Calculate statistics for each parameter
-        std::vector<double> kS_values, kV_values, kA_values;
-        for (const auto& result : results) {
-            kS_values.push_back(result.kS);
-            kV_values.push_back(result.kV);
-            kA_values.push_back(result.kA);
-        }
-        
-        // Calculate means and standard deviations
-        auto calculateStats = [](const std::vector<double>& values) {
-            double sum = 0.0, sumSq = 0.0;
-            for (double val : values) {
-                sum += val;
-                sumSq += val * val;
-            }
-            double mean = sum / values.size();
-            double variance = (sumSq / values.size()) - (mean * mean);
-            double stdDev = sqrt(variance);
-            return std::make_pair(mean, stdDev);
-        };
+        printf("Successful tests: %d/%d\n", successfulTests, runCount);
         
-        auto [kS_mean, kS_std] = calculateStats(kS_values);
-        auto [kV_mean, kV_std] = calculateStats(kV_values);
-        auto [kA_mean, kA_std] = calculateStats(kA_values);
-        
-        // Calculate coefficients of variation (CV = std/mean)
-        double kS_cv = kS_std / fabs(kS_mean);
-        double kV_cv = kV_std / fabs(kV_mean);
-        double kA_cv = kA_std / fabs(kA_mean);
+        // Sample standard deviations and coefficients of variation (CV = std/mean)
+        double kS_mean = results.kS.getMean(), kS_std = results.kS.getStdDev();
+        double kV_mean = results.kV.getMean(), kV_std = results.kV.getStdDev();
+        double kA_mean = results.kA.getMean(), kA_std = results.kA.getStdDev();
+        double kS_cv = results.kS.getCoefficientOfVariation();
+        double kV_cv = results.kV.getCoefficientOfVariation();
+        double kA_cv = results.kA.getCoefficientOfVariation();
         
         printf("\nParameter Statistics:\n");
-        printf("kS: %.4f ± %.4f V (CV: %.1f%%)\n", kS_mean, kS_std, kS_cv * 100);
-        printf("kV: %.4f ± %.4f V/RPM (CV: %.1f%%)\n", kV_mean, kV_std, kV_cv * 100);
-        printf("kA: %.6f ± %.6f V/(RPM/s) (CV: %.1f%%)\n", kA_mean, kA_std, kA_cv * 100);
+        printf("kS: %.4f ± %.4f V (CV: %.1f%%, range %.4f..%.4f)\n", kS_mean, kS_std, kS_cv * 100,
+               results.kS.getMin(), results.kS.getMax());
+        printf("kV: %.4f ± %.4f V/RPM (CV: %.1f%%, range %.4f..%.4f)\n", kV_mean, kV_std, kV_cv * 100,
+               results.kV.getMin(), results.kV.getMax());
+        printf("kA: %.6f ± %.6f V/(RPM/s) (CV: %.1f%%, range %.6f..%.6f)\n", kA_mean, kA_std, kA_cv * 100,
+               results.kA.getMin(), results.kA.getMax());
         
         // Consistency assessment
         printf("\nConsistency Assessment:\n");
@@ -320,15 +981,20 @@ void runConsistencyTest() {
         pros::lcd::print(1, "kS: %.3f±%.3f", kS_mean, kS_std);
         pros::lcd::print(2, "kV: %.4f±%.4f", kV_mean, kV_std);
         pros::lcd::print(3, "kA: %.5f±%.5f", kA_mean, kA_std);
-        pros::lcd::print(4, "Tests: %zu/5", results.size());
+        pros::lcd::print(4, "Tests: %d/%d, %s", successfulTests, runCount,
+                         SequentialConsistency::describe(sequence.getDecision()));
+        
+        // Store the averaged result; R^2 is the mean over the runs
+        saveToHistory(FeedforwardConstants(kS_mean, kV_mean, kA_mean), rSquaredValues.getMean(), totalDataPoints,
+                      20000 * runCount, HISTORY_CONSISTENCY_TEST, successfulTests);
         pros::lcd::print(5, "Press center to retest");
         
     } else {
         printf("\n❌ INSUFFICIENT DATA FOR CONSISTENCY ANALYSIS\n");
-        printf("Need at least 3 successful tests, got %zu\n", results.size());
+        printf("Need at least 2 successful tests, got %d\n", successfulTests);
         
         pros::lcd::print(0, "Insufficient data");
-        pros::lcd::print(1, "Only %zu/5 tests passed", results.size());
+        pros::lcd::print(1, "Only %d/%d tests passed", successfulTests, runCount);
         pros::lcd::print(2, "Check motor connection");
         pros::lcd::print(3, "Press center to retry");
     }
@@ -337,33 +1003,39 @@ void runConsistencyTest() {
 }
 
 /**
- * @brief Display motor characteristics on LCD
+ * @brief Display the latest stored characterization and its trend on LCD
  */
 void displayMotorCharacteristics() {
-    // Create local system identification object
-    SystemIdentification motorSysId;
+    const HistoryIndexEntry* entry = history.find(characterizationMotorKey);
     
-    if (!motorSysId.isSystemIdentified()) {
+    if (entry == nullptr) {
         pros::lcd::print(0, "No Characterization Data");
         pros::lcd::print(1, "Press center to start");
         return;
     }
     
-    FeedforwardConstants constants = motorSysId.getConstants();
+    const HistoryRecord& latest = entry->latest;
+    FeedforwardConstants constants(latest.kS, latest.kV, latest.kA);
     
-    pros::lcd::print(0, "Motor Characteristics");
+    pros::lcd::print(0, "%s (port %d)", latest.key.label, latest.key.port);
     pros::lcd::print(1, "kS: %.2f kV: %.3f kA: %.4f", constants.kS, constants.kV, constants.kA);
-    pros::lcd::print(2, "R^2: %.3f", motorSysId.getRSquared());
-    pros::lcd::print(3, "Data Points: %zu", motorSysId.getDataPointCount());
+    pros::lcd::print(2, "R^2: %.3f Points: %u", latest.rSquared, latest.dataPoints);
     
     // Calculate max velocity estimate (using 12V max)
     double maxVoltage = 12.0;
     double maxVelocity = (maxVoltage - constants.kS) / constants.kV;
-    pros::lcd::print(4, "Max Vel: %.0f RPM", maxVelocity);
+    pros::lcd::print(3, "Max Vel: %.0f RPM", maxVelocity);
     
-    // Show voltage for 100 RPM
-    double voltage100 = constants.calculate(100.0, 0.0);
-    pros::lcd::print(5, "100RPM: %.1fV", voltage100);
+    // Trend: change from the oldest result still in the index
+    const HistoryTrendPoint& oldest = entry->trend[0];
+    if (entry->trendCount > 1 && oldest.kS != 0.0f && oldest.kV != 0.0f) {
+        pros::lcd::print(4, "Trend: kS %+.0f%% kV %+.0f%%",
+                         (constants.kS / oldest.kS - 1.0) * 100.0,
+                         (constants.kV / oldest.kV - 1.0) * 100.0);
+    } else {
+        pros::lcd::print(4, "Trend: need more runs");
+    }
+    pros::lcd::print(5, "Runs on file: %u", entry->recordCount);
 }
 
 /**
@@ -377,19 +1049,36 @@ void on_right_button() {
     consistencyTestRequested = true;
 }
 
+void on_left_button() {
+    selectedMode = (selectedMode + 1) % MODE_COUNT;
+    modeChanged = true;
+}
+
 /**
  * Runs initialization code. This occurs as soon as the program is started.
  */
 void initialize() {
     pros::lcd::initialize();
     pros::lcd::set_text(0, "Motor Characterization");
-    pros::lcd::set_text(1, "Center: Single test");
-    pros::lcd::set_text(2, "Right: 5 tests");
+    pros::lcd::set_text(1, "Left: Change mode");
+    pros::lcd::set_text(2, "Center: Run mode");
+    pros::lcd::set_text(3, "Right: repeat tests");
+    pros::lcd::print(7, "Mode: %s", modeNames[selectedMode]);
     
+    pros::lcd::register_btn0_cb(on_left_button);
     pros::lcd::register_btn1_cb(on_center_button);
     pros::lcd::register_btn2_cb(on_right_button);
 
     std::cout << "Initializing" << std::endl;
+    
+    // Load the result index so the latest numbers are available immediately
+    if (pros::usd::is_installed() && history.load()) {
+        const HistoryIndexEntry* entry = history.find(characterizationMotorKey);
+        if (entry != nullptr) {
+            pros::lcd::print(5, "Last: kS %.2f kV %.3f", entry->latest.kS, entry->latest.kV);
+        }
+        printf("History: %u results for %zu motors\n", history.getRecordCount(), history.getEntries().size());
+    }
 }
 
 /**
@@ -425,10 +1114,34 @@ void opcontrol() {
     bool isCharacterizing = false;
 
     while (true) {
+        if (modeChanged && !isCharacterizing) {
+            modeChanged = false;
+            pros::lcd::print(7, "Mode: %s", modeNames[selectedMode]);
+            if (selectedMode == MODE_SAVED_RESULTS) {
+                displayMotorCharacteristics();
+            }
+        }
+        
         if (startRequested && !isCharacterizing) {
             isCharacterizing = true;
             startRequested = false;
-            runMotorCharacterization();
+            switch (selectedMode) {
+                case MODE_FREQUENCY_TEST:
+                    runFrequencyResponseTest();
+                    break;
+                case MODE_GROUP_TEST:
+                    runGroupCharacterization();
+                    break;
+                case MODE_ENDURANCE_TEST:
+                    runEnduranceTest();
+                    break;
+                case MODE_SAVED_RESULTS:
+                    displayMotorCharacteristics();
+                    break;
+                default:
+                    runMotorCharacterization();
+                    break;
+            }
             isCharacterizing = false;
         }
         
@@ -0,0 +1,76 @@
+#include "model_selection.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+namespace motor_characterization {
+
+namespace {
+
+const char* const kTermNames[SufficientStatistics::kTermCount] = {"S", "V", "A"};
+
+} // namespace
+
+std::vector<ModelCandidate> selectModels(const SufficientStatistics& statistics, double effectiveSamples) {
+    std::vector<ModelCandidate> candidates;
+    const double n = static_cast<double>(statistics.getCount());
+    const double informationSamples = effectiveSamples > 0.0 ? std::min(effectiveSamples, n) : n;
+    const double tss = statistics.totalSumSquares();
+
+    for (std::uint32_t terms = 1; terms < (1u << SufficientStatistics::kTermCount); ++terms) {
+        if (!(terms & TERM_VELOCITY)) continue;
+
+        ModelCandidate candidate{};
+        candidate.terms = terms;
+        for (int term = 0; term < SufficientStatistics::kTermCount; ++term) {
+            if (!(terms & (1u << term))) continue;
+            if (candidate.name[0] != '\0') std::strcat(candidate.name, "+");
+            std::strcat(candidate.name, kTermNames[term]);
+            candidate.parameters++;
+        }
+
+        candidate.fit = statistics.solve(terms);
+        const double k = candidate.parameters;
+        if (candidate.fit.valid && n > k + 1.0 && tss > 1e-10) {
+            // Gaussian log-likelihood up to a constant: -n/2 ln(RSS/n)
+            double logVariance = std::log(std::max(candidate.fit.residualSumSquares / n, 1e-300));
+            candidate.aic = informationSamples * logVariance + 2.0 * k;
+            candidate.bic = informationSamples * logVariance + k * std::log(informationSamples);
+            candidate.adjustedRSquared = 1.0 - (candidate.fit.residualSumSquares / (n - k)) / (tss / (n - 1.0));
+        } else {
+            candidate.fit.valid = false;
+        }
+        candidates.push_back(candidate);
+    }
+
+    std::sort(candidates.begin(), candidates.end(), [](const ModelCandidate& a, const ModelCandidate& b) {
+        if (a.fit.valid != b.fit.valid) return a.fit.valid;
+        return a.bic < b.bic;
+    });
+    if (!candidates.empty() && candidates.front().fit.valid) {
+        for (auto& candidate : candidates) {
+            candidate.deltaBic = candidate.fit.valid ? candidate.bic - candidates.front().bic : 0.0;
+        }
+    }
+    return candidates;
+}
+
+void printModelTable(const std::vector<ModelCandidate>& candidates) {
+    printf("\nModel       adj R^2     dAIC     dBIC   kS       kV        kA\n");
+    double bestAic = INFINITY;
+    for (const auto& candidate : candidates) {
+        if (candidate.fit.valid) bestAic = std::min(bestAic, candidate.aic);
+    }
+    for (const auto& candidate : candidates) {
+        if (!candidate.fit.valid) {
+            printf("%-10s  not identifiable\n", candidate.name);
+            continue;
+        }
+        printf("%-10s  %.5f  %7.1f  %7.1f   %.4f  %.5f  %.6f\n", candidate.name, candidate.adjustedRSquared,
+               candidate.aic - bestAic, candidate.deltaBic, candidate.fit.coefficients(0),
+               candidate.fit.coefficients(1), candidate.fit.coefficients(2));
+    }
+}
+
+} // namespace motor_characterization
@@ -0,0 +1,108 @@
+#include "motor_sampler.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace motor_characterization {
+
+bool MotorSampler::isSaturated(double commanded, double applied, double battery) {
+    if (battery > 0.0 && std::fabs(commanded) > battery - kSaturationHeadroom) {
+        return true;
+    }
+    return std::fabs(applied - commanded) > kSaturationTolerance;
+}
+
+void MotorSampler::setStateEstimator(MotorStateEstimator* stateEstimator) {
+    estimator = stateEstimator;
+    if (estimator != nullptr) {
+        motor.set_encoder_units(pros::v5::MotorUnits::degrees);
+        estimator->reset();
+    }
+    updateChannels();
+}
+
+void MotorSampler::setExtraChannels(std::uint32_t channels) {
+    extraChannels = channels;
+    updateChannels();
+}
+
+void MotorSampler::updateChannels() {
+    const std::uint32_t estimatorChannels =
+        estimator != nullptr ? static_cast<std::uint32_t>(TELEMETRY_POSITION) : 0u;
+    telemetry.setChannels(kRequiredChannels | extraChannels | estimatorChannels);
+}
+
+bool MotorSampler::sample(int commandMillivolts, double time, DataPoint& point) {
+    using namespace telemetry;
+
+    telemetry.read(frame);
+    frame.time = toField(time, kTimeScale, 0, 0x7FFFFFFF);
+    frame.command = static_cast<std::int16_t>(std::clamp(commandMillivolts, -32768, 32767));
+
+    double velocity = frame.velocity / kVelocityScale;
+    double commanded = commandMillivolts / 1000.0;
+    double acceleration = 0.0;
+
+    // Classify the tick before anything can return, so an abort is seen on this tick
+    MotorHealth health;
+    health.valid = (frame.channels & (TELEMETRY_CURRENT | TELEMETRY_FAULTS)) == (TELEMETRY_CURRENT | TELEMETRY_FAULTS);
+    if (health.valid) {
+        health.current = frame.current;
+        health.faults = frame.hardware & 0x0F;
+        health.flags = frame.hardware >> 4;
+    }
+    std::uint32_t faults = detector.update(health, velocity, commanded);
+
+    if (estimator != nullptr) {
+        // The estimator runs on its own clock so it can span voltage steps.
+        // A missing reading is passed as infinite, which the estimator skips.
+        double position = (frame.channels & TELEMETRY_POSITION) ? frame.position / kPositionScale : INFINITY;
+        double measured = (frame.channels & TELEMETRY_VELOCITY) ? velocity : INFINITY;
+        std::uint64_t now = pros::micros();
+        double dt = (now - estimatorMicros) / 1e6;
+        bool first = !estimator->isInitialized();
+        if (!first && dt <= 0.001) {
+            return false;
+        }
+        estimator->update(dt, commanded, position, measured);
+        estimatorMicros = now;
+        if (first) {
+            return false;
+        }
+        velocity = estimator->getVelocity();
+        acceleration = estimator->getAcceleration();
+    } else {
+        double previousV = previousVelocity;
+        double previousT = previousTime;
+        previousVelocity = velocity;
+        previousTime = time;
+
+        // Direct acceleration calculation without history arrays
+        double dt = time - previousT;
+        if (previousT <= 0 || dt <= 0.001) { // Avoid division by zero
+            return false;
+        }
+        acceleration = (velocity - previousV) / dt;
+    }
+
+    double applied = (frame.channels & TELEMETRY_APPLIED_VOLTAGE) ? frame.applied / 1000.0 : commanded;
+    double battery = (frame.channels & TELEMETRY_BATTERY_VOLTAGE) ? frame.battery / 1000.0 : 0.0;
+    bool saturated = isSaturated(commanded, applied, battery);
+
+    point = DataPoint(commanded, velocity, acceleration, time, applied, battery, saturated);
+    point.current = health.valid ? health.current / 1000.0 : 0.0;
+    point.faults = detector.isMasked(faults) ? faults : FAULT_NONE;
+    if (estimator != nullptr) {
+        point.velocityVariance = estimator->getVelocityVariance();
+        point.accelerationVariance = estimator->getAccelerationVariance();
+    }
+
+    // The frame carries what identification sees
+    frame.velocity = toField(velocity, kVelocityScale, -0x7FFFFFFF, 0x7FFFFFFF);
+    frame.acceleration = toField(acceleration, kAccelerationScale, -0x7FFFFFFF, 0x7FFFFFFF);
+    frame.faults = static_cast<std::uint16_t>(point.faults);
+    frame.status = saturated ? kStatusSaturated : 0;
+    if (fixedPoint != nullptr) fixedPoint->add(frame);
+    return true;
+}
+
+} // namespace motor_characterization
@@ -0,0 +1,124 @@
+#include "operating_point_analysis.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include "host_parallel.hpp"
+
+namespace motor_characterization {
+
+namespace {
+
+constexpr std::size_t kChunkSize = 512;  // Samples reduced per parallel task
+
+} // namespace
+
+OperatingPointAnalysis::OperatingPointAnalysis(const SystemIdentification& sysId,
+                                               const std::vector<double>& bandEdges) {
+    const auto& points = sysId.getDataPoints();
+    const std::size_t bandCount = bandEdges.size() > 1 ? bandEdges.size() - 1 : 0;
+
+    // Segment boundaries: a new segment starts whenever the command changes
+    std::vector<std::uint32_t> segmentOf(points.size());
+    std::vector<double> segmentVoltage;
+    for (std::size_t i = 0; i < points.size(); ++i) {
+        if (i == 0 || points[i].voltage != points[i - 1].voltage) {
+            segmentVoltage.push_back(points[i].voltage);
+        }
+        segmentOf[i] = static_cast<std::uint32_t>(segmentVoltage.size() - 1);
+    }
+    const std::size_t segmentCount = segmentVoltage.size();
+    const std::size_t groupCount = segmentCount + bandCount;
+
+    // Map: each chunk accumulates every group it touches
+    const std::size_t chunkCount = (points.size() + kChunkSize - 1) / kChunkSize;
+    std::vector<std::vector<GroupAccumulator>> partial(chunkCount);
+    parallelFor(chunkCount, [&](std::size_t chunk) {
+        std::vector<GroupAccumulator>& groups = partial[chunk];
+        groups.resize(groupCount);
+        std::size_t end = std::min(points.size(), (chunk + 1) * kChunkSize);
+        for (std::size_t i = chunk * kChunkSize; i < end; ++i) {
+            const DataPoint& point = points[i];
+            if (!sysId.isUsable(point)) continue;
+            double voltage = sysId.responseVoltage(point);
+            double speed = std::fabs(point.velocity);
+
+            GroupAccumulator& segment = groups[segmentOf[i]];
+            segment.statistics.add(point.velocity, point.acceleration, voltage);
+            segment.speedSum += speed;
+
+            auto edge = std::upper_bound(bandEdges.begin(), bandEdges.end(), speed);
+            std::size_t band = edge - bandEdges.begin();
+            if (band >= 1 && band <= bandCount) {
+                GroupAccumulator& group = groups[segmentCount + band - 1];
+                group.statistics.add(point.velocity, point.acceleration, voltage);
+                group.speedSum += speed;
+            }
+        }
+    });
+
+    // Reduce
+    std::vector<GroupAccumulator> groups(groupCount);
+    for (const auto& chunk : partial) {
+        for (std::size_t g = 0; g < groupCount; ++g) groups[g] += chunk[g];
+    }
+    SufficientStatistics total;
+    for (std::size_t s = 0; s < segmentCount; ++s) total += groups[s].statistics;
+    globalFit = total.solve(TERM_ALL);
+
+    segments.resize(segmentCount);
+    bands.resize(bandCount);
+    parallelFor(groupCount, [&](std::size_t g) {
+        if (g < segmentCount) {
+            segments[g] = solveGroup(groups[g], segmentVoltage[g], segmentVoltage[g]);
+        } else {
+            std::size_t band = g - segmentCount;
+            bands[band] = solveGroup(groups[g], bandEdges[band], bandEdges[band + 1]);
+        }
+    });
+}
+
+LocalFit OperatingPointAnalysis::solveGroup(const GroupAccumulator& group, double lower, double upper) const {
+    LocalFit local = {};
+    local.lower = lower;
+    local.upper = upper;
+    local.samples = group.statistics.getCount();
+    local.meanSpeed = local.samples > 0 ? group.speedSum / local.samples : 0.0;
+    if (!globalFit.valid) return local;
+
+    SufficientStatistics reduced = group.statistics.withFixedTerm(TERM_ACCELERATION, globalFit.coefficients(2));
+    StatisticsFit fit = reduced.solve(TERM_STATIC_FRICTION | TERM_VELOCITY);
+    if (!fit.valid) return local;
+
+    local.kS = fit.coefficients(0);
+    local.kV = fit.coefficients(1);
+    local.kSError = std::sqrt(std::max(fit.covariance(0, 0), 0.0));
+    local.kVError = std::sqrt(std::max(fit.covariance(1, 1), 0.0));
+    local.rSquared = fit.rSquared;
+    local.valid = true;
+    return local;
+}
+
+void OperatingPointAnalysis::printTables() const {
+    printf("\nLocal fits (kA fixed at %.6f)\n", globalFit.coefficients(2));
+    printf("Segment  Command  |v| mean  Points  kS               kV\n");
+    for (std::size_t i = 0; i < segments.size(); ++i) {
+        const LocalFit& fit = segments[i];
+        if (fit.valid) {
+            printf("%7zu  %6.2fV  %8.1f  %6u  %6.3f ± %-6.3f  %.5f ± %.5f\n", i + 1, fit.lower, fit.meanSpeed,
+                   fit.samples, fit.kS, fit.kSError, fit.kV, fit.kVError);
+        } else {
+            printf("%7zu  %6.2fV  %8.1f  %6u  not separable\n", i + 1, fit.lower, fit.meanSpeed, fit.samples);
+        }
+    }
+    printf("Band (RPM)   |v| mean  Points  kS               kV\n");
+    for (const auto& fit : bands) {
+        if (fit.valid) {
+            printf("%4.0f-%-4.0f     %8.1f  %6u  %6.3f ± %-6.3f  %.5f ± %.5f\n", fit.lower, fit.upper,
+                   fit.meanSpeed, fit.samples, fit.kS, fit.kSError, fit.kV, fit.kVError);
+        } else {
+            printf("%4.0f-%-4.0f     %8.1f  %6u  not separable\n", fit.lower, fit.upper, fit.meanSpeed, fit.samples);
+        }
+    }
+}
+
+} // namespace motor_characterization
@@ -0,0 +1,180 @@
+#include "output_error.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace motor_characterization {
+
+namespace {
+
+constexpr double kMaxDamping = 1e6;
+
+/**
+ * @brief Squared error sums of one simulation
+ */
+struct SimulationPass {
+    Eigen::Matrix3d normal;     // J^T J, upper triangle
+    Eigen::Vector3d gradient;   // J^T r
+    double sumSquares;
+    std::uint32_t samples;
+};
+
+/**
+ * @brief Voltage that drove the motor over the interval after a sample
+ */
+double drivingVoltage(const SystemIdentification& sysId, const DataPoint& point) {
+    // A saturated command was not delivered; the reported voltage is what the motor saw
+    return point.saturated ? point.appliedVoltage : sysId.responseVoltage(point);
+}
+
+/**
+ * @brief Advance the simulated velocity and its sensitivities over one interval
+ * @return Velocity at the end of the interval
+ */
+double step(double velocity, Eigen::Vector3d& sensitivity, double voltage, double dt, const Eigen::Vector3d& p,
+            bool withJacobian) {
+    const double kS = p(0);
+    const double kV = p(1);
+    const double kA = p(2);
+
+    // Friction sign over the step; a stopped motor only moves if the voltage beats kS
+    double sign = velocity > 0.0 ? 1.0 : velocity < 0.0 ? -1.0 : 0.0;
+    if (sign == 0.0 && std::fabs(voltage) > kS) sign = voltage > 0.0 ? 1.0 : -1.0;
+    if (sign == 0.0) {
+        sensitivity.setZero();
+        return 0.0;
+    }
+
+    // Exact step of dv/dt = (V - kS s - kV v) / kA with V and s held
+    const double alpha = std::exp(-kV * dt / kA);
+    const double target = (voltage - kS * sign) / kV;
+    const double next = alpha * velocity + (1.0 - alpha) * target;
+
+    if (withJacobian) {
+        const double gap = velocity - target;
+        const Eigen::Vector3d dAlpha(0.0, -dt / kA * alpha, kV * dt / (kA * kA) * alpha);
+        const Eigen::Vector3d dTarget(-sign / kV, -target / kV, 0.0);
+        sensitivity = alpha * sensitivity + gap * dAlpha + (1.0 - alpha) * dTarget;
+    }
+
+    // Crossing zero ends the step at zero; it restarts from there with the new sign
+    if (next * sign < 0.0) {
+        sensitivity.setZero();
+        return 0.0;
+    }
+    return next;
+}
+
+/**
+ * @brief Simulate the capture and accumulate the error (and optionally the Jacobian)
+ * @return False if the constants cannot be simulated
+ */
+bool simulate(const SystemIdentification& sysId, const Eigen::Vector3d& p, bool withJacobian, SimulationPass& pass) {
+    pass.normal.setZero();
+    pass.gradient.setZero();
+    pass.sumSquares = 0.0;
+    pass.samples = 0;
+    if (!(p(0) >= 0.0) || !(p(1) > 0.0) || !(p(2) > 0.0)) return false;
+
+    const auto& points = sysId.getDataPoints();
+    if (points.size() < 2) return false;
+
+    // Start from the first measurement; its sensitivities are zero
+    double velocity = points[0].velocity;
+    Eigen::Vector3d sensitivity = Eigen::Vector3d::Zero();
+
+    double samplePeriod = 0.0;  // Latest spacing between samples of one step
+    for (std::size_t k = 0; k + 1 < points.size(); ++k) {
+        const double dt = points[k + 1].timestamp - points[k].timestamp;
+        if (dt > 0.0) {
+            samplePeriod = dt;
+            velocity = step(velocity, sensitivity, drivingVoltage(sysId, points[k]), dt, p, withJacobian);
+        } else {
+            // Timestamps restart at zero on every profile step. The old voltage still
+            // drives the motor for about one sample period after the step's last
+            // sample, then the new one from the step's start to its first sample.
+            if (samplePeriod > 0.0) {
+                velocity = step(velocity, sensitivity, drivingVoltage(sysId, points[k]), samplePeriod, p,
+                                withJacobian);
+            }
+            if (points[k + 1].timestamp > 0.0) {
+                velocity = step(velocity, sensitivity, drivingVoltage(sysId, points[k + 1]),
+                                points[k + 1].timestamp, p, withJacobian);
+            }
+        }
+
+        const DataPoint& measured = points[k + 1];
+        if (!sysId.isUsable(measured)) continue;
+        const double residual = measured.velocity - velocity;
+        pass.sumSquares += residual * residual;
+        pass.samples++;
+        if (withJacobian) {
+            pass.normal.selfadjointView<Eigen::Upper>().rankUpdate(sensitivity);
+            pass.gradient += sensitivity * residual;
+        }
+    }
+    return pass.samples > 3 && std::isfinite(pass.sumSquares);
+}
+
+} // namespace
+
+OutputErrorFit OutputErrorRefinement::refine(const SystemIdentification& sysId, const FeedforwardConstants& seed,
+                                             const OutputErrorOptions& options) {
+    OutputErrorFit result;
+    Eigen::Vector3d parameters(std::max(seed.kS, 0.0), seed.kV, seed.kA);
+
+    SimulationPass pass;
+    if (!simulate(sysId, parameters, true, pass)) return result;
+    result.initialRms = std::sqrt(pass.sumSquares / pass.samples);
+
+    double damping = options.initialDamping;
+    for (int iteration = 0; iteration < options.maxIterations; ++iteration) {
+        const Eigen::Matrix3d normal = pass.normal.selfadjointView<Eigen::Upper>();
+        const double before = pass.sumSquares;
+
+        // Raise the damping until a step lowers the error
+        bool improved = false;
+        SimulationPass trial;
+        while (!improved && damping <= kMaxDamping) {
+            Eigen::Matrix3d damped = normal;
+            damped.diagonal() *= 1.0 + damping;
+            Eigen::LDLT<Eigen::Matrix3d> ldlt(damped);
+            if (ldlt.info() != Eigen::Success) break;
+            const Eigen::Vector3d candidate = parameters + ldlt.solve(pass.gradient);
+            if (simulate(sysId, candidate, true, trial) && trial.sumSquares < before) {
+                parameters = candidate;
+                pass = trial;
+                damping = std::max(damping * 0.1, 1e-9);
+                improved = true;
+            } else {
+                damping *= 10.0;
+            }
+        }
+        result.iterations = iteration + 1;
+        if (!improved || before - pass.sumSquares < options.tolerance * before) break;
+    }
+
+    // Covariance from the final Jacobian
+    const Eigen::Matrix3d normal = pass.normal.selfadjointView<Eigen::Upper>();
+    Eigen::LDLT<Eigen::Matrix3d> ldlt(normal);
+    if (ldlt.info() != Eigen::Success) return result;
+    const double variance = pass.sumSquares / (pass.samples - 3);
+    const Eigen::Matrix3d covariance = ldlt.solve(Eigen::Matrix3d::Identity()) * variance;
+    for (int i = 0; i < 3; ++i) result.standardError(i) = std::sqrt(std::max(covariance(i, i), 0.0));
+
+    result.constants = FeedforwardConstants(parameters(0), parameters(1), parameters(2), seed.velocityDeadband);
+    result.finalRms = std::sqrt(pass.sumSquares / pass.samples);
+    result.samples = pass.samples;
+    result.valid = true;
+    return result;
+}
+
+double OutputErrorRefinement::simulationError(const SystemIdentification& sysId,
+                                              const FeedforwardConstants& constants) {
+    SimulationPass pass;
+    if (!simulate(sysId, Eigen::Vector3d(constants.kS, constants.kV, constants.kA), false, pass)) {
+        return INFINITY;
+    }
+    return std::sqrt(pass.sumSquares / pass.samples);
+}
+
+} // namespace motor_characterization
@@ -0,0 +1,126 @@
+#include "resampling.hpp"
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include "host_parallel.hpp"
+
+namespace motor_characterization {
+
+BlockResampler::BlockResampler(const SystemIdentification& sysId, std::size_t blockLength) {
+    blockLength = std::max<std::size_t>(blockLength, 1);
+    SufficientStatistics block;
+    for (const auto& point : sysId.getDataPoints()) {
+        if (!sysId.isUsable(point)) continue;
+        block.add(point.velocity, point.acceleration, sysId.responseVoltage(point));
+        if (block.getCount() == blockLength) {
+            blocks.push_back(block);
+            total += block;
+            block.clear();
+        }
+    }
+    if (block.getCount() > 0) {
+        blocks.push_back(block);
+        total += block;
+    }
+}
+
+CrossValidationResult BlockResampler::crossValidate(int folds, std::uint32_t terms) const {
+    CrossValidationResult result;
+    const std::size_t blockCount = blocks.size();
+    if (folds < 2 || blockCount < static_cast<std::size_t>(folds)) {
+        return result;
+    }
+
+    // Each fold is a contiguous run of blocks, held out from a fit on the rest
+    std::vector<double> foldError(folds, 0.0);
+    std::vector<char> foldValid(folds, 0);
+    parallelFor(folds, [&](std::size_t fold) {
+        SufficientStatistics heldOut;
+        for (std::size_t b = blockCount * fold / folds; b < blockCount * (fold + 1) / folds; ++b) {
+            heldOut += blocks[b];
+        }
+        SufficientStatistics training = total;
+        training -= heldOut;
+
+        StatisticsFit fit = training.solve(terms);
+        if (fit.valid) {
+            foldError[fold] = heldOut.residualSumSquares(fit.coefficients);
+            foldValid[fold] = 1;
+        }
+    });
+
+    double press = 0.0;
+    for (int fold = 0; fold < folds; ++fold) {
+        if (!foldValid[fold]) return result;
+        press += foldError[fold];
+    }
+
+    double tss = total.totalSumSquares();
+    result.folds = folds;
+    result.outOfSampleRSquared = tss > 1e-10 ? 1.0 - press / tss : 0.0;
+    result.rootMeanSquareError = std::sqrt(press / total.getCount());
+    result.valid = true;
+    return result;
+}
+
+BootstrapResult BlockResampler::bootstrap(int replicates, double confidenceLevel, std::uint32_t seed,
+                                          std::uint32_t terms) const {
+    BootstrapResult result;
+    result.confidenceLevel = confidenceLevel;
+    if (replicates < 2 || blocks.size() < 2) {
+        return result;
+    }
+
+    std::vector<Eigen::Vector3d> estimates(replicates);
+    std::vector<char> valid(replicates, 0);
+    parallelFor(replicates, [&](std::size_t replicate) {
+        // Seed per replicate so results do not depend on the thread count
+        std::seed_seq sequence{seed, static_cast<std::uint32_t>(replicate)};
+        std::mt19937 rng(sequence);
+        std::uniform_int_distribution<std::size_t> pick(0, blocks.size() - 1);
+
+        SufficientStatistics resampled;
+        for (std::size_t i = 0; i < blocks.size(); ++i) {
+            resampled += blocks[pick(rng)];
+        }
+        StatisticsFit fit = resampled.solve(terms);
+        if (fit.valid) {
+            estimates[replicate] = fit.coefficients;
+            valid[replicate] = 1;
+        }
+    });
+
+    std::vector<Eigen::Vector3d> accepted;
+    accepted.reserve(replicates);
+    for (int i = 0; i < replicates; ++i) {
+        if (valid[i]) accepted.push_back(estimates[i]);
+    }
+    const std::size_t count = accepted.size();
+    if (count < 2) {
+        return result;
+    }
+
+    result.replicates = static_cast<int>(count);
+    for (const auto& estimate : accepted) result.mean += estimate;
+    result.mean /= static_cast<double>(count);
+    for (const auto& estimate : accepted) {
+        result.standardError += (estimate - result.mean).cwiseAbs2();
+    }
+    result.standardError = (result.standardError / static_cast<double>(count - 1)).cwiseSqrt();
+
+    // Percentile interval per parameter
+    std::vector<double> values(count);
+    double tail = (1.0 - confidenceLevel) / 2.0;
+    std::size_t lowerIndex = static_cast<std::size_t>(std::floor(tail * (count - 1)));
+    std::size_t upperIndex = static_cast<std::size_t>(std::ceil((1.0 - tail) * (count - 1)));
+    for (int parameter = 0; parameter < 3; ++parameter) {
+        for (std::size_t i = 0; i < count; ++i) values[i] = accepted[i](parameter);
+        std::nth_element(values.begin(), values.begin() + lowerIndex, values.end());
+        result.lower(parameter) = values[lowerIndex];
+        std::nth_element(values.begin(), values.begin() + upperIndex, values.end());
+        result.upper(parameter) = values[upperIndex];
+    }
+    return result;
+}
+
+} // namespace motor_characterization
@@ -0,0 +1,48 @@
+#include "running_statistics.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace motor_characterization {
+
+void RunningStatistics::clear() {
+    count = 0;
+    mean = 0.0;
+    squaredDeviations = 0.0;
+    minimum = INFINITY;
+    maximum = -INFINITY;
+}
+
+void RunningStatistics::add(double value) {
+    if (!std::isfinite(value)) return;
+    count++;
+    double delta = value - mean;
+    mean += delta / count;
+    squaredDeviations += delta * (value - mean);
+    minimum = std::min(minimum, value);
+    maximum = std::max(maximum, value);
+}
+
+RunningStatistics& RunningStatistics::operator+=(const RunningStatistics& other) {
+    if (other.count == 0) return *this;
+    if (count == 0) return *this = other;
+
+    // Chan et al.: the combined spread is both spreads plus the gap between the means
+    const double total = static_cast<double>(count) + other.count;
+    const double delta = other.mean - mean;
+    mean += delta * other.count / total;
+    squaredDeviations += other.squaredDeviations + delta * delta * count * other.count / total;
+    count += other.count;
+    minimum = std::min(minimum, other.minimum);
+    maximum = std::max(maximum, other.maximum);
+    return *this;
+}
+
+double RunningStatistics::getStdDev() const {
+    return std::sqrt(std::max(getVariance(), 0.0));
+}
+
+double RunningStatistics::getCoefficientOfVariation() const {
+    return mean != 0.0 ? getStdDev() / std::fabs(mean) : INFINITY;
+}
+
+} // namespace motor_characterization
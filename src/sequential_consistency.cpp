@@ -0,0 +1,101 @@
+#include "sequential_consistency.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace motor_characterization {
+
+namespace {
+
+constexpr int kTableDegrees = 20;
+
+// Two-sided 95% Student t quantiles (0.975) for 1 .. 20 degrees of freedom
+constexpr double kStudentT[kTableDegrees] = {
+    12.706, 4.303, 3.182, 2.776, 2.571, 2.447, 2.365, 2.306, 2.262, 2.228,
+    2.201,  2.179, 2.160, 2.145, 2.131, 2.120, 2.110, 2.101, 2.093, 2.086};
+
+// Upper 95% chi-square quantiles for 1 .. 20 degrees of freedom
+constexpr double kChiSquare[kTableDegrees] = {
+    3.841,  5.991,  7.815,  9.488,  11.070, 12.592, 14.067, 15.507, 16.919, 18.307,
+    19.675, 21.026, 22.362, 23.685, 24.996, 26.296, 27.587, 28.869, 30.144, 31.410};
+
+double studentT(int degrees) {
+    if (degrees <= kTableDegrees) return kStudentT[degrees - 1];
+    return 1.960 + 2.4 / degrees;  // Within 0.01 of the exact value past the table
+}
+
+double chiSquare(int degrees) {
+    if (degrees <= kTableDegrees) return kChiSquare[degrees - 1];
+    // Wilson-Hilferty approximation
+    double k = degrees;
+    double c = 1.0 - 2.0 / (9.0 * k) + 1.645 * std::sqrt(2.0 / (9.0 * k));
+    return k * c * c * c;
+}
+
+} // namespace
+
+SequentialConsistency::SequentialConsistency(const ConsistencyOptions& options)
+    : options(options), statistics(), runCount(0), decision(CONSISTENCY_CONTINUE) {
+    this->options.minRuns = std::max(this->options.minRuns, 2);
+    this->options.minRunsToReject = std::max(this->options.minRunsToReject, 2);
+}
+
+ConsistencyDecision SequentialConsistency::addRun(const FeedforwardConstants& constants) {
+    runCount++;
+    statistics.add(constants);
+    decision = decide();
+    return decision;
+}
+
+ConsistencyDecision SequentialConsistency::addFailedRun() {
+    runCount++;
+    decision = decide();
+    return decision;
+}
+
+double SequentialConsistency::relativeHalfWidth(int term) const {
+    const RunningStatistics& values = statistics[term];
+    const std::uint32_t n = values.getCount();
+    if (n < 2 || values.getMean() == 0.0) return INFINITY;
+    return studentT(static_cast<int>(n) - 1) * values.getStdDev() / std::sqrt(static_cast<double>(n)) /
+           std::fabs(values.getMean());
+}
+
+double SequentialConsistency::spreadLowerBound(int term) const {
+    const RunningStatistics& values = statistics[term];
+    const std::uint32_t n = values.getCount();
+    if (n < 2 || values.getMean() == 0.0) return 0.0;
+    const int degrees = static_cast<int>(n) - 1;
+    return values.getCoefficientOfVariation() * std::sqrt(degrees / chiSquare(degrees));
+}
+
+ConsistencyDecision SequentialConsistency::decide() const {
+    const int successful = getSuccessfulRuns();
+
+    if (successful >= options.minRunsToReject) {
+        for (int term = 0; term < 3; ++term) {
+            if (spreadLowerBound(term) > options.inconsistentSpread[term]) return CONSISTENCY_INCONSISTENT;
+        }
+    }
+
+    if (successful >= options.minRuns) {
+        bool converged = true;
+        for (int term = 0; term < 3; ++term) {
+            converged = converged && relativeHalfWidth(term) <= options.targetHalfWidth[term];
+        }
+        if (converged) return CONSISTENCY_CONVERGED;
+    }
+
+    return runCount >= options.maxRuns ? CONSISTENCY_RUN_LIMIT : CONSISTENCY_CONTINUE;
+}
+
+const char* SequentialConsistency::describe(ConsistencyDecision decision) {
+    switch (decision) {
+        case CONSISTENCY_CONTINUE: return "running";
+        case CONSISTENCY_CONVERGED: return "converged";
+        case CONSISTENCY_INCONSISTENT: return "inconsistent";
+        case CONSISTENCY_RUN_LIMIT: return "run limit";
+    }
+    return "unknown";
+}
+
+} // namespace motor_characterization
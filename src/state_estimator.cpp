@@ -0,0 +1,79 @@
+#include "state_estimator.hpp"
+#include <cmath>
+
+namespace motor_characterization {
+
+namespace {
+
+constexpr double kDegreesPerRevolution = 360.0;
+constexpr double kSecondsPerMinute = 60.0;
+constexpr double kDegreesPerSecondPerRpm = kDegreesPerRevolution / kSecondsPerMinute;
+constexpr double kUnknownVariance = 1e12;
+
+} // namespace
+
+void MotorStateEstimator::update(double dt, double commandedVoltage, double position, double velocity) {
+    if (!initialized) {
+        state << (std::isfinite(position) ? position : 0.0), (std::isfinite(velocity) ? velocity : 0.0), 0.0;
+        covariance.setZero();
+        covariance(0, 0) = std::isfinite(position) ? options.positionNoise * options.positionNoise
+                                                   : kUnknownVariance;
+        covariance(1, 1) = std::isfinite(velocity) ? options.velocityNoise * options.velocityNoise
+                                                   : kUnknownVariance;
+        covariance(2, 2) = options.initialAcceleration * options.initialAcceleration;
+        command = commandedVoltage;
+        initialized = true;
+        return;
+    }
+
+    // A new command changes the acceleration at the start of the interval
+    double jump = options.accelerationPerVolt * (commandedVoltage - command);
+    command = commandedVoltage;
+    if (options.shiftAcceleration) state(2) += jump;
+    covariance(2, 2) += jump * jump;
+
+    // Predict: acceleration decaying over dt, position in deg from velocity in RPM
+    if (dt > 0.0) {
+        const double c = kDegreesPerSecondPerRpm;
+        double decay = 1.0;
+        double velocityGain = dt;              // Integral of the acceleration decay over dt
+        double positionGain = 0.5 * dt * dt;   // Double integral
+        if (options.timeConstant > 0.0) {
+            const double tau = options.timeConstant;
+            decay = std::exp(-dt / tau);
+            velocityGain = tau * (1.0 - decay);
+            positionGain = tau * (dt - velocityGain);
+        }
+        Eigen::Matrix3d transition;
+        transition << 1.0, c * dt, c * positionGain,
+                      0.0, 1.0, velocityGain,
+                      0.0, 0.0, decay;
+
+        // Discretized white jerk noise, with the position rows scaled to degrees
+        const double q = options.jerkNoise * options.jerkNoise;
+        const double dt2 = dt * dt;
+        const double dt3 = dt2 * dt;
+        Eigen::Matrix3d noise;
+        noise << c * c * dt3 * dt2 / 20.0, c * dt2 * dt2 / 8.0, c * dt3 / 6.0,
+                 c * dt2 * dt2 / 8.0, dt3 / 3.0, dt2 / 2.0,
+                 c * dt3 / 6.0, dt2 / 2.0, dt;
+
+        state = transition * state;
+        covariance = transition * covariance * transition.transpose() + q * noise;
+    }
+
+    if (std::isfinite(position)) correct(0, position, options.positionNoise * options.positionNoise);
+    if (std::isfinite(velocity)) correct(1, velocity, options.velocityNoise * options.velocityNoise);
+}
+
+void MotorStateEstimator::correct(int index, double measurement, double variance) {
+    double innovationVariance = covariance(index, index) + variance;
+    if (!(innovationVariance > 0.0)) return;
+
+    Eigen::Vector3d gain = covariance.col(index) / innovationVariance;
+    state += gain * (measurement - state(index));
+    covariance -= gain * covariance.row(index);
+    covariance = 0.5 * (covariance + covariance.transpose()).eval();
+}
+
+} // namespace motor_characterization
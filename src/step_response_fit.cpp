@@ -0,0 +1,244 @@
+#include "step_response_fit.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include "running_statistics.hpp"
+#include "sufficient_statistics.hpp"
+
+namespace motor_characterization {
+
+namespace {
+
+constexpr int kMaxStepHalvings = 5;
+
+} // namespace
+
+StepResponseFit::StepResponseFit(const SystemIdentification& sysId, const StepResponseOptions& options)
+    : options(options), constants(), errors(), valid(false) {
+    const auto& points = sysId.getDataPoints();
+
+    // A new segment starts whenever the command changes
+    std::size_t begin = 0;
+    for (std::size_t i = 1; i <= points.size(); ++i) {
+        if (i == points.size() || points[i].voltage != points[i - 1].voltage) {
+            segments.push_back(fitSegment(sysId, begin, i));
+            begin = i;
+        }
+    }
+
+    // Steady state of each segment: V = kS sign(v) + kV v
+    SufficientStatistics steady;
+    for (const auto& segment : segments) {
+        if (segment.valid) steady.add(segment.finalVelocity, 0.0, segment.voltage);
+    }
+    if (steady.getCount() < 3) return;
+    StatisticsFit fit = steady.solve(TERM_STATIC_FRICTION | TERM_VELOCITY);
+    if (!fit.valid || !(fit.coefficients(1) > 0.0)) return;
+
+    // Time constant kA / kV, inverse-variance weighted over the segments
+    double weightSum = 0.0;
+    double weightedTau = 0.0;
+    for (const auto& segment : segments) {
+        if (!segment.valid || !segment.timeConstantValid) continue;
+        double weight = 1.0 / (segment.timeConstantError * segment.timeConstantError);
+        weightSum += weight;
+        weightedTau += weight * segment.timeConstant;
+    }
+    if (!(weightSum > 0.0)) return;
+    const double tau = weightedTau / weightSum;
+    const double tauError = 1.0 / std::sqrt(weightSum);
+
+    const double kV = fit.coefficients(1);
+    const double kVError = std::sqrt(std::max(fit.covariance(1, 1), 0.0));
+    constants = FeedforwardConstants(fit.coefficients(0), kV, kV * tau);
+    errors[0] = std::sqrt(std::max(fit.covariance(0, 0), 0.0));
+    errors[1] = kVError;
+    errors[2] = std::hypot(kVError * tau, kV * tauError);
+    valid = true;
+}
+
+StepSegmentFit StepResponseFit::fitSegment(const SystemIdentification& sysId, std::size_t begin,
+                                           std::size_t end) const {
+    const auto& points = sysId.getDataPoints();
+    StepSegmentFit result = {};
+    result.voltage = points[begin].voltage;
+
+    std::uint32_t usable = 0;
+    for (std::size_t i = begin; i < end; ++i) usable += sysId.isUsable(points[i]) ? 1 : 0;
+    if (usable < options.minSamples) return result;
+
+    // Initial final-velocity guess from the tail of the segment
+    const std::uint32_t tailSamples =
+        std::max<std::uint32_t>(1, static_cast<std::uint32_t>(usable * options.tailFraction));
+    double tailSum = 0.0;
+    std::uint32_t seen = 0;
+    for (std::size_t i = begin; i < end; ++i) {
+        if (!sysId.isUsable(points[i])) continue;
+        if (seen++ >= usable - tailSamples) tailSum += points[i].velocity;
+    }
+    const double tailMean = tailSum / tailSamples;
+    if (std::fabs(tailMean) < options.minSteadySpeed) return result;
+    const double sign = tailMean > 0.0 ? 1.0 : -1.0;
+
+    // Window: after the last friction sign change, then after the velocity starts moving
+    std::size_t start = begin;
+    for (std::size_t i = begin; i < end; ++i) {
+        if (sysId.isUsable(points[i]) && points[i].velocity * sign <= 0.0) start = i + 1;
+    }
+    while (start < end && !sysId.isUsable(points[start])) start++;
+    if (start >= end) return result;
+    const double firstStep = points[start].velocity - tailMean;
+    if (std::fabs(firstStep) >= options.minStepSize) {
+        while (start < end && (!sysId.isUsable(points[start]) ||
+                               std::fabs(points[start].velocity - tailMean) > 0.9 * std::fabs(firstStep))) {
+            start++;
+        }
+    }
+
+    const double t0 = start < end ? points[start].timestamp : 0.0;
+    double voltageSum = 0.0;
+    RunningStatistics velocities;
+    for (std::size_t i = start; i < end; ++i) {
+        if (!sysId.isUsable(points[i])) continue;
+        voltageSum += sysId.responseVoltage(points[i]);
+        velocities.add(points[i].velocity);
+    }
+    const std::uint32_t count = velocities.getCount();
+    if (count < options.minSamples) return result;
+    result.samples = count;
+    result.voltage = voltageSum / count;
+
+    const double delta0 = points[start].velocity - tailMean;
+    if (std::fabs(delta0) < options.minStepSize) {
+        // Already settled: the mean is the final velocity, there is no decay to time
+        const double mean = velocities.getMean();
+        const double variance = velocities.getPopulationVariance();
+        result.initialVelocity = mean;
+        result.finalVelocity = mean;
+        result.finalVelocityError = std::sqrt(variance / count);
+        result.rmsResidual = std::sqrt(variance);
+        result.valid = true;
+        return result;
+    }
+
+    // Seed: log-linear fit of ln|v - vFinal| over the middle of the decay, weighted by
+    // the squared distance so the noisy end of the decay counts less
+    double sw = 0.0, st = 0.0, sy = 0.0, stt = 0.0, sty = 0.0;
+    for (std::size_t i = start; i < end; ++i) {
+        if (!sysId.isUsable(points[i])) continue;
+        double distance = (points[i].velocity - tailMean) * (delta0 > 0.0 ? 1.0 : -1.0);
+        if (distance <= 0.1 * std::fabs(delta0) || distance >= std::fabs(delta0)) continue;
+        double t = points[i].timestamp - t0;
+        double y = std::log(distance);
+        double w = distance * distance;
+        sw += w;
+        st += w * t;
+        sy += w * y;
+        stt += w * t * t;
+        sty += w * t * y;
+    }
+    const double duration = points[end - 1].timestamp - t0;
+    double rate = duration > 0.0 ? 5.0 / duration : 10.0;
+    double denominator = sw * stt - st * st;
+    if (denominator > 0.0) {
+        double slope = (sw * sty - st * sy) / denominator;
+        if (slope < 0.0) rate = -slope;
+    }
+
+    // Refine v(t) = vFinal + delta exp(-rate t) by Gauss-Newton
+    Eigen::Vector3d parameters(tailMean, delta0, rate);
+    Eigen::Matrix3d normal;
+    Eigen::Vector3d gradient;
+    auto accumulate = [&](const Eigen::Vector3d& p, bool withJacobian) {
+        double sse = 0.0;
+        if (withJacobian) {
+            normal.setZero();
+            gradient.setZero();
+        }
+        for (std::size_t i = start; i < end; ++i) {
+            if (!sysId.isUsable(points[i])) continue;
+            const double t = points[i].timestamp - t0;
+            const double decay = std::exp(-p(2) * t);
+            const double residual = points[i].velocity - (p(0) + p(1) * decay);
+            sse += residual * residual;
+            if (withJacobian) {
+                const Eigen::Vector3d j(1.0, decay, -p(1) * t * decay);
+                normal.selfadjointView<Eigen::Upper>().rankUpdate(j);
+                gradient += j * residual;
+            }
+        }
+        return sse;
+    };
+
+    double sse = accumulate(parameters, true);
+    for (int iteration = 0; iteration < options.iterations; ++iteration) {
+        Eigen::LDLT<Eigen::Matrix3d> ldlt(normal.selfadjointView<Eigen::Upper>());
+        if (ldlt.info() != Eigen::Success) break;
+        Eigen::Vector3d step = ldlt.solve(gradient);
+        bool improved = false;
+        for (int halving = 0; halving < kMaxStepHalvings && !improved; ++halving, step *= 0.5) {
+            Eigen::Vector3d candidate = parameters + step;
+            if (!(candidate(2) > 0.0)) continue;
+            double candidateSse = accumulate(candidate, false);
+            if (candidateSse < sse) {
+                parameters = candidate;
+                sse = candidateSse;
+                improved = true;
+            }
+        }
+        if (!improved) break;
+        accumulate(parameters, true);
+    }
+
+    Eigen::Matrix3d full = normal.selfadjointView<Eigen::Upper>();
+    Eigen::LDLT<Eigen::Matrix3d> ldlt(full);
+    if (ldlt.info() != Eigen::Success || count <= 3) return result;
+    const Eigen::Matrix3d covariance = ldlt.solve(Eigen::Matrix3d::Identity()) * (sse / (count - 3));
+
+    result.finalVelocity = parameters(0);
+    result.initialVelocity = parameters(0) + parameters(1);
+    result.finalVelocityError = std::sqrt(std::max(covariance(0, 0), 0.0));
+    result.rmsResidual = std::sqrt(sse / count);
+    result.valid = std::isfinite(result.finalVelocity);
+
+    const double rateError = std::sqrt(std::max(covariance(2, 2), 0.0));
+    result.timeConstant = 1.0 / parameters(2);
+    result.timeConstantError = rateError / (parameters(2) * parameters(2));
+    result.timeConstantValid = result.valid && result.timeConstantError > 0.0 && rateError < parameters(2);
+    return result;
+}
+
+void StepResponseFit::printTable(const FeedforwardConstants& regression) const {
+    printf("\nStep response fit\n");
+    printf("Segment  Voltage  Points  Final (RPM)       Tau (ms)      RMS (RPM)\n");
+    for (std::size_t i = 0; i < segments.size(); ++i) {
+        const StepSegmentFit& fit = segments[i];
+        if (!fit.valid) {
+            printf("%7zu  %6.2fV  %6u  not settled\n", i + 1, fit.voltage, fit.samples);
+        } else if (fit.timeConstantValid) {
+            printf("%7zu  %6.2fV  %6u  %7.1f ± %-6.1f  %5.0f ± %-5.0f  %.1f\n", i + 1, fit.voltage, fit.samples,
+                   fit.finalVelocity, fit.finalVelocityError, fit.timeConstant * 1000.0,
+                   fit.timeConstantError * 1000.0, fit.rmsResidual);
+        } else {
+            printf("%7zu  %6.2fV  %6u  %7.1f ± %-6.1f  -              %.1f\n", i + 1, fit.voltage, fit.samples,
+                   fit.finalVelocity, fit.finalVelocityError, fit.rmsResidual);
+        }
+    }
+    if (!valid) {
+        printf("Not enough settled segments for constants\n");
+        return;
+    }
+
+    const double fitted[3] = {constants.kS, constants.kV, constants.kA};
+    const double reference[3] = {regression.kS, regression.kV, regression.kA};
+    const char* const names[3] = {"kS", "kV", "kA"};
+    printf("       Step response          Regression   Difference\n");
+    for (int term = 0; term < 3; ++term) {
+        double difference = fitted[term] - reference[term];
+        printf("%s  %10.6f ± %-9.6f  %10.6f   %+.1f%% (%.1f sigma)\n", names[term], fitted[term], errors[term],
+               reference[term], reference[term] != 0.0 ? 100.0 * difference / std::fabs(reference[term]) : 0.0,
+               errors[term] > 0.0 ? std::fabs(difference) / errors[term] : 0.0);
+    }
+}
+
+} // namespace motor_characterization
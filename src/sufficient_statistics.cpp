@@ -0,0 +1,77 @@
+#include "sufficient_statistics.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace motor_characterization {
+
+StatisticsFit SufficientStatistics::solve(std::uint32_t terms) const {
+    using SmallMatrix = Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, 0, kTermCount, kTermCount>;
+    using SmallVector = Eigen::Matrix<double, Eigen::Dynamic, 1, 0, kTermCount, 1>;
+
+    StatisticsFit fit;
+
+    int index[kTermCount];
+    int size = 0;
+    for (int term = 0; term < kTermCount; ++term) {
+        if (terms & (1u << term)) index[size++] = term;
+    }
+    if (size == 0 || count <= static_cast<std::uint32_t>(size)) {
+        return fit;
+    }
+
+    // Gather the sub-problem with unit diagonal (Jacobi scaling), so the
+    // singularity test below measures collinearity rather than units.
+    // Fixed capacity keeps this allocation-free.
+    const Eigen::Matrix3d full = gram.selfadjointView<Eigen::Upper>();
+    SmallVector scale(size);
+    for (int i = 0; i < size; ++i) {
+        double diagonal = full(index[i], index[i]);
+        if (!(diagonal > 0.0)) return fit;
+        scale(i) = 1.0 / std::sqrt(diagonal);
+    }
+    SmallMatrix subGram(size, size);
+    SmallVector subCross(size);
+    for (int i = 0; i < size; ++i) {
+        subCross(i) = crossProduct(index[i]) * scale(i);
+        for (int j = 0; j < size; ++j) {
+            subGram(i, j) = full(index[i], index[j]) * scale(i) * scale(j);
+        }
+    }
+
+    Eigen::LLT<SmallMatrix> cholesky(subGram);
+    if (cholesky.info() != Eigen::Success) {
+        return fit;
+    }
+    // Squared pivots below 1e-10 mean a term is (almost) a combination of the others
+    if (!(cholesky.matrixLLT().diagonal().minCoeff() > 1e-5)) {
+        return fit;
+    }
+
+    SmallVector scaledBeta = cholesky.solve(subCross);
+    if (!scaledBeta.allFinite()) {
+        return fit;
+    }
+    SmallVector beta = scaledBeta.cwiseProduct(scale);
+
+    for (int i = 0; i < size; ++i) {
+        fit.coefficients(index[i]) = beta(i);
+    }
+    // RSS = y^T y - beta^T X^T y at the least squares solution
+    fit.residualSumSquares = std::max(responseSumSquares - scaledBeta.dot(subCross), 0.0);
+
+    // Covariance from the scaled inverse: (X^T X)^-1 = S (S X^T X S)^-1 S
+    SmallMatrix inverse = cholesky.solve(SmallMatrix::Identity(size, size));
+    double residualVariance = fit.residualSumSquares / (count - size);
+    for (int i = 0; i < size; ++i) {
+        for (int j = 0; j < size; ++j) {
+            fit.covariance(index[i], index[j]) = residualVariance * inverse(i, j) * scale(i) * scale(j);
+        }
+    }
+
+    double tss = totalSumSquares();
+    fit.rSquared = tss > 1e-10 ? 1.0 - fit.residualSumSquares / tss : 0.0;
+    fit.valid = true;
+    return fit;
+}
+
+} // namespace motor_characterization
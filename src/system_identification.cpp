@@ -1,51 +1,127 @@
 #include "system_identification.hpp"
-#include <fstream>
-#include <sstream>
-#include <iomanip>
+#include "csv_writer.hpp"
+#include <cstdio>
 #include <numeric>
 
 namespace motor_characterization {
 
+namespace {
+
+/**
+ * @brief Inverse of the standard normal CDF (Acklam's rational approximation)
+ */
+double normalQuantile(double p) {
+    static const double a[] = {-3.969683028665376e+01, 2.209460984245205e+02, -2.759285104469687e+02,
+                               1.383577518672690e+02, -3.066479806614716e+01, 2.506628277459239e+00};
+    static const double b[] = {-5.447609879822406e+01, 1.615858368580409e+02, -1.556989798598866e+02,
+                               6.680131188771972e+01, -1.328068155288572e+01};
+    static const double c[] = {-7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                               -2.549732539343734e+00, 4.374664141464968e+00, 2.938163982698783e+00};
+    static const double d[] = {7.784695709041462e-03, 3.224671290700398e-01, 2.445134137142996e+00,
+                               3.754408661907416e+00};
+    
+    if (p <= 0.0 || p >= 1.0) return p <= 0.0 ? -INFINITY : INFINITY;
+    if (p < 0.02425 || p > 1.0 - 0.02425) {
+        double q = std::sqrt(-2.0 * std::log(p < 0.5 ? p : 1.0 - p));
+        double x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+                   ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+        return p < 0.5 ? x : -x;
+    }
+    double q = p - 0.5;
+    double r = q * q;
+    return (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+           (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+}
+
+/**
+ * @brief Quantile of Student's t distribution (Cornish-Fisher expansion)
+ *
+ * Accurate to a few parts in a thousand for 3 or more degrees of freedom,
+ * which is far below the uncertainty of the variance estimate itself.
+ */
+double studentQuantile(double p, double dof) {
+    double z = normalQuantile(p);
+    double z2 = z * z;
+    double g1 = (z2 + 1.0) * z / 4.0;
+    double g2 = ((5.0 * z2 + 16.0) * z2 + 3.0) * z / 96.0;
+    double g3 = (((3.0 * z2 + 19.0) * z2 + 17.0) * z2 - 15.0) * z / 384.0;
+    return z + g1 / dof + g2 / (dof * dof) + g3 / (dof * dof * dof);
+}
+
+} // namespace
+
 // SystemIdentification implementation
+size_t SystemIdentification::getUsableDataPointCount() const {
+    return std::count_if(dataPoints.begin(), dataPoints.end(),
+                         [this](const DataPoint& point) { return isUsable(point); });
+}
+
 Eigen::MatrixXd SystemIdentification::buildDesignMatrix(bool includeStaticFriction, bool includeAcceleration) const {
-    size_t numPoints = dataPoints.size();
+    size_t numPoints = getUsableDataPointCount();
     size_t numFeatures = 1; // Always include velocity
     if (includeStaticFriction) numFeatures++;
     if (includeAcceleration) numFeatures++;
     
     Eigen::MatrixXd X(numPoints, numFeatures);
     
-    for (size_t i = 0; i < numPoints; ++i) {
+    size_t row = 0;
+    for (const auto& point : dataPoints) {
+        if (!isUsable(point)) continue;
         size_t col = 0;
         
-        // Static friction term (sign of velocity)
+        // Static friction term (sign of velocity, zero when stopped)
         if (includeStaticFriction) {
-            X(i, col++) = dataPoints[i].velocity > 0 ? 1.0 : -1.0;
+            X(row, col++) = frictionSign(point.velocity);
         }
         
         // Velocity term
-        X(i, col++) = dataPoints[i].velocity;
+        X(row, col++) = point.velocity;
         
         // Acceleration term
         if (includeAcceleration) {
-            X(i, col++) = dataPoints[i].acceleration;
+            X(row, col++) = point.acceleration;
         }
+        row++;
     }
     
     return X;
 }
 
 Eigen::VectorXd SystemIdentification::buildResponseVector() const {
-    size_t numPoints = dataPoints.size();
+    size_t numPoints = getUsableDataPointCount();
     Eigen::VectorXd y(numPoints);
     
-    for (size_t i = 0; i < numPoints; ++i) {
-        y(i) = dataPoints[i].voltage;
+    size_t row = 0;
+    for (const auto& point : dataPoints) {
+        if (!isUsable(point)) continue;
+        y(row++) = responseVoltage(point);
     }
     
     return y;
 }
 
+bool SystemIdentification::buildVarianceWeights(double residualVariance, Eigen::VectorXd& weights) const {
+    weights.resize(getUsableDataPointCount());
+    
+    // Equation error each sample's state uncertainty adds through kV and kA
+    bool anyVariance = false;
+    size_t row = 0;
+    for (const auto& point : dataPoints) {
+        if (!isUsable(point)) continue;
+        anyVariance = anyVariance || point.velocityVariance > 0.0 || point.accelerationVariance > 0.0;
+        weights(row++) = constants.kV * constants.kV * point.velocityVariance +
+                         constants.kA * constants.kA * point.accelerationVariance;
+    }
+    if (!anyVariance || weights.size() == 0) return false;
+    
+    // Whatever the state variance does not explain is common to all samples;
+    // keep a floor so a few very certain samples cannot take over the fit
+    double baseVariance = std::max(residualVariance - weights.mean(), 0.1 * residualVariance);
+    if (!(baseVariance > 0.0)) return false;
+    weights = (weights.array() + baseVariance).inverse();
+    return weights.allFinite();
+}
+
 double SystemIdentification::calculateRSquared(const Eigen::VectorXd& predicted, const Eigen::VectorXd& actual) const {
     if (predicted.size() != actual.size() || predicted.size() == 0) return 0.0;
     
@@ -61,7 +137,7 @@ double SystemIdentification::calculateRSquared(const Eigen::VectorXd& predicted,
 }
 
 bool SystemIdentification::identify(bool includeStaticFriction, bool includeAcceleration) {
-    if (dataPoints.size() < 3) {
+    if (getUsableDataPointCount() < 3) {
         // Need at least 3 data points for meaningful identification
         return false;
     }
@@ -96,9 +172,39 @@ bool SystemIdentification::identify(bool includeStaticFriction, bool includeAcce
             constants.kA = 0.0;
         }
         
-        // Calculate R-squared
+        // Map design matrix columns to kS, kV, kA for the covariance
+        std::vector<int> columns;
+        if (includeStaticFriction) columns.push_back(0);
+        columns.push_back(1);
+        if (includeAcceleration) columns.push_back(2);
+        
+        // Second pass weighted by each sample's state variance, if known
+        weighted = false;
+        Eigen::VectorXd weights;
+        double residualVariance = (y - X * beta).squaredNorm() / std::max<double>(X.rows() - X.cols(), 1.0);
+        if (useVarianceWeights && buildVarianceWeights(residualVariance, weights)) {
+            Eigen::VectorXd scale = weights.cwiseSqrt();
+            Eigen::MatrixXd weightedX = scale.asDiagonal() * X;
+            Eigen::VectorXd weightedY = scale.cwiseProduct(y);
+            Eigen::VectorXd weightedBeta = weightedX.colPivHouseholderQr().solve(weightedY);
+            if (weightedBeta.allFinite()) {
+                beta = weightedBeta;
+                size_t column = 0;
+                constants.kS = includeStaticFriction ? beta(column++) : 0.0;
+                constants.kV = beta(column++);
+                constants.kA = includeAcceleration ? beta(column++) : 0.0;
+                calculateUncertainty(X, y - X * beta, columns, weights);
+                weighted = true;
+            }
+        }
+        
+        // Calculate R-squared (unweighted, so it compares across runs)
         Eigen::VectorXd predicted = X * beta;
         rSquared = calculateRSquared(predicted, y);
+        
+        if (!weighted) {
+            calculateUncertainty(X, y - predicted, columns, Eigen::VectorXd());
+        }
         isIdentified = true;
         
         return true;
@@ -108,6 +214,67 @@ bool SystemIdentification::identify(bool includeStaticFriction, bool includeAcce
     }
 }
 
+void SystemIdentification::calculateUncertainty(const Eigen::MatrixXd& X, const Eigen::VectorXd& residuals,
+                                                const std::vector<int>& columns, const Eigen::VectorXd& weights) {
+    uncertainty = ParameterUncertainty();
+    uncertainty.confidenceLevel = confidenceLevel;
+    
+    const double n = static_cast<double>(X.rows());
+    const double p = static_cast<double>(X.cols());
+    if (n <= p) return;
+    
+    // Spread and correlation in volts, from the unweighted residuals
+    uncertainty.residualStdDev = std::sqrt(residuals.squaredNorm() / (n - p));
+    
+    // Lag-1 autocorrelation of the residuals
+    double lagProduct = 0.0;
+    for (Eigen::Index i = 1; i < residuals.size(); ++i) {
+        lagProduct += residuals(i) * residuals(i - 1);
+    }
+    double sumSquares = residuals.squaredNorm();
+    double rho = sumSquares > 0.0 ? lagProduct / sumSquares : 0.0;
+    uncertainty.residualAutocorrelation = rho;
+    
+    // AR(1) approximation: correlated samples carry less information, as if
+    // there were n (1 - rho) / (1 + rho) independent ones
+    if (correctAutocorrelation) {
+        rho = std::clamp(rho, 0.0, 0.99);
+        uncertainty.varianceInflation = (1.0 + rho) / (1.0 - rho);
+    }
+    uncertainty.effectiveSamples = n / uncertainty.varianceInflation;
+    
+    // Covariance from the weighted residuals and Gram matrix when the fit was weighted
+    const bool weighted = weights.size() == residuals.size();
+    double residualVariance = weighted ? residuals.cwiseAbs2().dot(weights) / (n - p)
+                                       : residuals.squaredNorm() / (n - p);
+    Eigen::MatrixXd gram = weighted ? Eigen::MatrixXd(X.transpose() * weights.asDiagonal() * X)
+                                    : Eigen::MatrixXd(X.transpose() * X);
+    Eigen::MatrixXd inverse = gram.ldlt().solve(Eigen::MatrixXd::Identity(X.cols(), X.cols()));
+    if (!inverse.allFinite()) return;
+    
+    double dof = std::max(uncertainty.effectiveSamples - p, 1.0);
+    double t = studentQuantile(0.5 + confidenceLevel / 2.0, dof);
+    for (size_t i = 0; i < columns.size(); ++i) {
+        for (size_t j = 0; j < columns.size(); ++j) {
+            uncertainty.covariance(columns[i], columns[j]) =
+                residualVariance * uncertainty.varianceInflation * inverse(i, j);
+        }
+    }
+    for (int i = 0; i < 3; ++i) {
+        uncertainty.standardError(i) = std::sqrt(std::max(uncertainty.covariance(i, i), 0.0));
+        uncertainty.confidenceHalfWidth(i) = t * uncertainty.standardError(i);
+    }
+}
+
+SufficientStatistics SystemIdentification::getSufficientStatistics() const {
+    SufficientStatistics statistics;
+    for (const auto& point : dataPoints) {
+        if (!isUsable(point)) continue;
+        statistics.add(point.velocity, point.acceleration, responseVoltage(point));
+    }
+    return statistics;
+}
+
 Eigen::MatrixXd SystemIdentification::getDesignMatrix(bool includeStaticFriction, bool includeAcceleration) const {
     return buildDesignMatrix(includeStaticFriction, includeAcceleration);
 }
@@ -123,36 +290,80 @@ void SystemIdentification::printResults() const {
     }
     
     printf("=== System Identification Results ===\n");
-    printf("Data points: %zu\n", dataPoints.size());
+    printf("Data points: %zu (%zu used)\n", dataPoints.size(), getUsableDataPointCount());
+    printf("Voltage: %s\n", voltageSource == VOLTAGE_MEASURED ? "measured" : "commanded");
+    if (weighted) {
+        printf("Weighting: state estimate variance\n");
+    }
     printf("R-squared: %.4f\n", rSquared);
-    printf("\nFeedforward Constants:\n");
-    printf("kS (Static Friction): %.4f\n", constants.kS);
-    printf("kV (Velocity): %.4f\n", constants.kV);
-    printf("kA (Acceleration): %.4f\n", constants.kA);
+    printf("\nFeedforward Constants (%.0f%% confidence):\n", uncertainty.confidenceLevel * 100.0);
+    printf("kS (Static Friction): %.4f ± %.4f\n", constants.kS, uncertainty.confidenceHalfWidth(0));
+    printf("kV (Velocity): %.4f ± %.4f\n", constants.kV, uncertainty.confidenceHalfWidth(1));
+    printf("kA (Acceleration): %.4f ± %.4f\n", constants.kA, uncertainty.confidenceHalfWidth(2));
+    printf("Residual std dev: %.4f (lag-1 correlation %.2f, variance x%.1f)\n", uncertainty.residualStdDev,
+           uncertainty.residualAutocorrelation, uncertainty.varianceInflation);
     printf("\nModel: V = kS*sign(v) + kV*v + kA*a\n");
     printf("=====================================\n");
 }
 
 bool SystemIdentification::exportToCSV(const std::string& filename) const {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
+    // Original four-column layout
+    return exportToCSV(filename, CsvExportOptions(CSV_TIMESTAMP | CSV_VOLTAGE | CSV_VELOCITY | CSV_ACCELERATION));
+}
+
+bool SystemIdentification::exportToCSV(const std::string& filename, const CsvExportOptions& options) const {
+    // Exportable columns in output order. New telemetry channels are added here.
+    struct ColumnDefinition {
+        CsvColumn column;
+        const char* header;
+        double (*extract)(const DataPoint&);
+    };
+    static const ColumnDefinition kColumns[] = {
+        {CSV_TIMESTAMP, "Timestamp", [](const DataPoint& p) { return p.timestamp; }},
+        {CSV_VOLTAGE, "Voltage", [](const DataPoint& p) { return p.voltage; }},
+        {CSV_VELOCITY, "Velocity", [](const DataPoint& p) { return p.velocity; }},
+        {CSV_ACCELERATION, "Acceleration", [](const DataPoint& p) { return p.acceleration; }},
+        {CSV_APPLIED_VOLTAGE, "AppliedVoltage", [](const DataPoint& p) { return p.appliedVoltage; }},
+        {CSV_BATTERY_VOLTAGE, "BatteryVoltage", [](const DataPoint& p) { return p.batteryVoltage; }},
+        {CSV_SATURATED, "Saturated", [](const DataPoint& p) { return p.saturated ? 1.0 : 0.0; }},
+        {CSV_VELOCITY_VARIANCE, "VelocityVariance", [](const DataPoint& p) { return p.velocityVariance; }},
+        {CSV_ACCELERATION_VARIANCE, "AccelerationVariance", [](const DataPoint& p) { return p.accelerationVariance; }},
+        {CSV_CURRENT, "Current", [](const DataPoint& p) { return p.current; }},
+        {CSV_FAULTS, "Faults", [](const DataPoint& p) { return static_cast<double>(p.faults); }},
+    };
+    
+    std::FILE* file = std::fopen(filename.c_str(), "w");
+    if (file == nullptr) {
         return false;
     }
     
+    // Resolve the selected columns once instead of testing the mask per field
+    const ColumnDefinition* selected[sizeof(kColumns) / sizeof(kColumns[0])];
+    size_t selectedCount = 0;
+    for (const auto& definition : kColumns) {
+        if (options.columns & definition.column) {
+            selected[selectedCount++] = &definition;
+        }
+    }
+    
+    CsvWriter writer(file);
+    
     // Write header
-    file << "Timestamp,Voltage,Velocity,Acceleration\n";
+    for (size_t i = 0; i < selectedCount; ++i) {
+        writer.writeText(selected[i]->header);
+    }
+    writer.endRow();
     
     // Write data
     for (const auto& point : dataPoints) {
-        file << std::fixed << std::setprecision(6)
-             << point.timestamp << ","
-             << point.voltage << ","
-             << point.velocity << ","
-             << point.acceleration << "\n";
+        for (size_t i = 0; i < selectedCount; ++i) {
+            writer.writeField(selected[i]->extract(point), options.precision);
+        }
+        writer.endRow();
     }
     
-    file.close();
-    return true;
+    bool success = writer.flush();
+    return std::fclose(file) == 0 && success;
 }
 
 } // namespace motor_characterization
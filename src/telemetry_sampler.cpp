@@ -0,0 +1,158 @@
+#include "telemetry_sampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace motor_characterization {
+
+using namespace telemetry;
+
+namespace {
+
+constexpr std::int32_t kInt16Min = std::numeric_limits<std::int16_t>::min();
+constexpr std::int32_t kInt16Max = std::numeric_limits<std::int16_t>::max();
+constexpr std::int32_t kInt32Min = -std::numeric_limits<std::int32_t>::max();
+constexpr std::int32_t kInt32Max = std::numeric_limits<std::int32_t>::max();
+
+} // namespace
+
+TelemetrySampler::TelemetrySampler(pros::Motor& motor, std::uint32_t channels)
+    : motor(motor), channels(channels & TELEMETRY_ALL_CHANNELS) {
+    resetCost();
+}
+
+void TelemetrySampler::resetCost() {
+    ticks = 0;
+    tickMicros = 0;
+    maxTickMicros = 0;
+    std::fill(std::begin(channelMicros), std::end(channelMicros), 0);
+    std::fill(std::begin(channelReads), std::end(channelReads), 0);
+}
+
+bool TelemetrySampler::readChannel(int channel, TelemetryFrame& frame) {
+    // PROS_ERR_F is infinite, so the finiteness checks also catch failed reads
+    switch (1u << channel) {
+        case TELEMETRY_VELOCITY: {
+            double velocity = motor.get_actual_velocity();
+            if (!std::isfinite(velocity)) return false;
+            frame.velocity = toField(velocity, kVelocityScale, kInt32Min, kInt32Max);
+            return true;
+        }
+        case TELEMETRY_APPLIED_VOLTAGE: {
+            std::int32_t millivolts = motor.get_voltage();
+            if (millivolts == PROS_ERR) return false;
+            frame.applied = static_cast<std::int16_t>(std::clamp(millivolts, kInt16Min, kInt16Max));
+            return true;
+        }
+        case TELEMETRY_BATTERY_VOLTAGE: {
+            std::int32_t millivolts = pros::battery::get_voltage();
+            if (millivolts == PROS_ERR || millivolts < 0) return false;
+            frame.battery = static_cast<std::uint16_t>(std::min<std::int32_t>(millivolts, 0xFFFF));
+            return true;
+        }
+        case TELEMETRY_CURRENT: {
+            std::int32_t milliamps = motor.get_current_draw();
+            if (milliamps == PROS_ERR) return false;
+            frame.current = static_cast<std::int16_t>(std::clamp(milliamps, kInt16Min, kInt16Max));
+            return true;
+        }
+        case TELEMETRY_FAULTS: {
+            std::uint32_t flags = motor.get_flags();
+            std::uint32_t faults = motor.get_faults();
+            if (faults == static_cast<std::uint32_t>(PROS_ERR)) {
+                // The fault word carries both limits; ask for them one by one only if it failed
+                std::int32_t overTemp = motor.is_over_temp();
+                std::int32_t overCurrent = motor.is_over_current();
+                if (overTemp == PROS_ERR || overCurrent == PROS_ERR) return false;
+                faults = (overTemp ? pros::E_MOTOR_FAULT_MOTOR_OVER_TEMP : 0) |
+                         (overCurrent ? pros::E_MOTOR_FAULT_OVER_CURRENT : 0);
+            }
+            if (flags == static_cast<std::uint32_t>(PROS_ERR)) return false;
+            frame.hardware = static_cast<std::uint8_t>((faults & 0x0F) | ((flags & 0x0F) << 4));
+            return true;
+        }
+        case TELEMETRY_POSITION: {
+            double position = motor.get_position();
+            if (!std::isfinite(position)) return false;
+            frame.position = toField(position, kPositionScale, kInt32Min, kInt32Max);
+            return true;
+        }
+        case TELEMETRY_TORQUE: {
+            double torque = motor.get_torque();
+            if (!std::isfinite(torque)) return false;
+            frame.torque = static_cast<std::int16_t>(toField(torque, kTorqueScale, kInt16Min, kInt16Max));
+            return true;
+        }
+        case TELEMETRY_POWER: {
+            double power = motor.get_power();
+            if (!std::isfinite(power)) return false;
+            frame.power = static_cast<std::int16_t>(toField(power, kPowerScale, kInt16Min, kInt16Max));
+            return true;
+        }
+        case TELEMETRY_EFFICIENCY: {
+            double efficiency = motor.get_efficiency();
+            if (!std::isfinite(efficiency)) return false;
+            frame.efficiency = static_cast<std::uint8_t>(toField(efficiency, 1.0, 0, 0xFF));
+            return true;
+        }
+        case TELEMETRY_TEMPERATURE: {
+            double temperature = motor.get_temperature();
+            if (!std::isfinite(temperature)) return false;
+            frame.temperature = static_cast<std::int8_t>(toField(temperature, 1.0, -128, 127));
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+void TelemetrySampler::read(TelemetryFrame& frame) {
+    frame.velocity = 0;
+    frame.position = 0;
+    frame.applied = 0;
+    frame.battery = 0;
+    frame.current = 0;
+    frame.torque = 0;
+    frame.power = 0;
+    frame.efficiency = 0;
+    frame.temperature = 0;
+    frame.hardware = 0;
+
+    std::uint32_t present = 0;
+    const std::uint64_t tickStart = pros::micros();
+    std::uint64_t readStart = tickStart;
+    for (int channel = 0; channel < kTelemetryChannelCount; ++channel) {
+        if (!(channels & (1u << channel))) continue;
+        if (readChannel(channel, frame)) present |= 1u << channel;
+        std::uint64_t readEnd = pros::micros();
+        channelMicros[channel] += readEnd - readStart;
+        channelReads[channel]++;
+        readStart = readEnd;
+    }
+    frame.channels = static_cast<std::uint16_t>(present);
+
+    const std::uint32_t elapsed = static_cast<std::uint32_t>(readStart - tickStart);
+    tickMicros += elapsed;
+    maxTickMicros = std::max(maxTickMicros, elapsed);
+    ticks++;
+}
+
+TelemetryCost TelemetrySampler::getCost() const {
+    TelemetryCost cost;
+    cost.ticks = ticks;
+    cost.maxTickMicros = maxTickMicros;
+    if (ticks > 0) cost.meanTickMicros = static_cast<double>(tickMicros) / ticks;
+
+    std::uint64_t totalMicros = 0;
+    std::uint64_t totalReads = 0;
+    for (int channel = 0; channel < kTelemetryChannelCount; ++channel) {
+        if (channelReads[channel] == 0) continue;
+        cost.channelMicros[channel] = static_cast<double>(channelMicros[channel]) / channelReads[channel];
+        totalMicros += channelMicros[channel];
+        totalReads += channelReads[channel];
+    }
+    if (totalReads > 0) cost.meanChannelMicros = static_cast<double>(totalMicros) / totalReads;
+    return cost;
+}
+
+} // namespace motor_characterization
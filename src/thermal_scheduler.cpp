@@ -0,0 +1,109 @@
+#include "thermal_scheduler.hpp"
+#include <algorithm>
+#include <cmath>
+
+namespace motor_characterization {
+
+namespace {
+
+constexpr double kReadingStep = 5.0;         // V5 temperature resolution (C)
+constexpr double kMinTimeConstant = 10.0;    // Plausible cooling time constants (s)
+constexpr double kMaxTimeConstant = 7200.0;
+constexpr double kMinAmbient = -20.0;        // Plausible ambient temperatures (C)
+constexpr double kMaxAmbient = 80.0;
+
+} // namespace
+
+// ThermalModel implementation
+double ThermalModel::predictCooling(double temperature, double seconds) const {
+    if (!valid) return temperature;
+    return ambient + (temperature - ambient) * std::exp(-std::max(seconds, 0.0) / timeConstant);
+}
+
+double ThermalModel::timeToCool(double temperature, double target) const {
+    if (temperature <= target) return 0.0;
+    if (!valid || target <= ambient) return INFINITY;
+    return timeConstant * std::log((temperature - ambient) / (target - ambient));
+}
+
+// ThermalScheduler implementation
+ThermalScheduler::ThermalScheduler(double tolerance, double maxWait)
+    : tolerance(tolerance), maxWait(maxWait), haveReference(false), referenceTemperature(0.0),
+      lastRunEnd(-1.0), lastRunTemperature(0.0), restTime(-1.0), restTemperature(0.0),
+      gram(Eigen::Matrix3d::Zero()), cross(Eigen::Vector3d::Zero()) {}
+
+void ThermalScheduler::recordRun(double startTime, double startTemperature, double endTime, double endTemperature,
+                                 double meanCurrentSquared) {
+    if (!haveReference) {
+        referenceTemperature = startTemperature;
+        haveReference = true;
+    }
+    addInterval(endTime - startTime, startTemperature, endTemperature, meanCurrentSquared);
+
+    lastRunEnd = endTime;
+    lastRunTemperature = endTemperature;
+    restTime = endTime;
+    restTemperature = endTemperature;
+}
+
+void ThermalScheduler::observeRest(double time, double temperature) {
+    if (restTime >= 0.0) {
+        addInterval(time - restTime, restTemperature, temperature, 0.0);
+    }
+    restTime = time;
+    restTemperature = temperature;
+}
+
+void ThermalScheduler::addInterval(double duration, double startTemperature, double endTemperature,
+                                   double meanCurrentSquared) {
+    if (!(duration > 0.0) || !std::isfinite(startTemperature) || !std::isfinite(endTemperature)) {
+        return;
+    }
+
+    // Slope over the interval against the midpoint state, weighted by its length
+    const Eigen::Vector3d x(1.0, 0.5 * (startTemperature + endTemperature), meanCurrentSquared);
+    const double slope = (endTemperature - startTemperature) / duration;
+    gram.selfadjointView<Eigen::Upper>().rankUpdate(x, duration);
+    cross += duration * slope * x;
+
+    // Refit with Jacobi scaling; reject when a column is not yet identifiable
+    model.valid = false;
+    const Eigen::Matrix3d full = gram.selfadjointView<Eigen::Upper>();
+    const Eigen::Vector3d diagonal = full.diagonal();
+    if ((diagonal.array() <= 0.0).any()) return;
+    const Eigen::Vector3d scale = diagonal.cwiseSqrt().cwiseInverse();
+    Eigen::LDLT<Eigen::Matrix3d> ldlt(scale.asDiagonal() * full * scale.asDiagonal());
+    if (ldlt.info() != Eigen::Success || ldlt.vectorD().minCoeff() < 1e-9) return;
+    const Eigen::Vector3d coefficients = scale.cwiseProduct(ldlt.solve(scale.cwiseProduct(cross)));
+
+    // dT/dt = a + b T + c I^2 with a = ambient / tau, b = -1 / tau, c = heating
+    if (!(coefficients(1) < 0.0)) return;
+    const double timeConstant = -1.0 / coefficients(1);
+    const double ambient = coefficients(0) * timeConstant;
+    if (timeConstant < kMinTimeConstant || timeConstant > kMaxTimeConstant || ambient < kMinAmbient ||
+        ambient > kMaxAmbient) {
+        return;
+    }
+    model.timeConstant = timeConstant;
+    model.ambient = ambient;
+    model.heating = coefficients(2);
+    model.valid = true;
+}
+
+double ThermalScheduler::predictTemperature(double time, double temperature) const {
+    if (!model.valid || lastRunEnd < 0.0) return temperature;
+    double predicted = model.predictCooling(lastRunTemperature, time - lastRunEnd);
+    return std::clamp(predicted, temperature - kReadingStep / 2.0, temperature + kReadingStep / 2.0);
+}
+
+double ThermalScheduler::getStartLimit() const {
+    return haveReference ? referenceTemperature + tolerance : INFINITY;
+}
+
+bool ThermalScheduler::readyToStart(double time, double temperature) const {
+    if (!haveReference) return true;
+    if (lastRunEnd >= 0.0 && time - lastRunEnd >= maxWait) return true;
+    return predictTemperature(time, temperature) <= getStartLimit();
+}
+
+} // namespace motor_characterization